@@ -0,0 +1,57 @@
+/*****************************************************************************
+* FreeAct configuration for the Blinky-Button example
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2023 Quantum Leaps, LLC. All rights reserved.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_CONFIG_H
+#define FREE_ACT_CONFIG_H
+
+/* The defaults for all settings are in FreeAct.h. Override only
+* what the application needs to be different.
+*/
+
+/* assertions: 0 - none, 1 - API and resource checks, 2 - all (default) */
+#ifdef NDEBUG
+    #define FREEACT_ASSERT_LEVEL    1
+#else
+    #define FREEACT_ASSERT_LEVEL    2
+#endif
+
+/* AO event queues: FREEACT_QUEUE_FREERTOS or FREEACT_QUEUE_NOTIFY */
+#define FREEACT_QUEUE               FREEACT_QUEUE_NOTIFY
+
+/* tracing hooks FreeAct_tracePost()/FreeAct_traceDispatch() (0 or 1) */
+#define FREEACT_TRACE               0
+
+/* 1 - TimeEvent_arm()/_disarm() detect the ISR context at run time,
+*  0 - ISRs must call TimeEvent_armFromISR()/_disarmFromISR()
+*/
+#define FREEACT_ISR_DETECT          0
+
+/* high-resolution TimeEvents on a hardware compare timer (0 or 1),
+* provided by the EK-TM4C123GXL (TIMER0) and NUCLEO-H743ZI (TIM2) BSPs
+*/
+#define FREEACT_HR_TIMER            0
+
+/* critical-section profiler (0 or 1), e.g., 'make CS_PROF=1', which also
+* wraps the port's vPortEnterCritical()/vPortExitCritical() at link time
+*/
+#ifndef FREEACT_CS_PROF
+#define FREEACT_CS_PROF             0
+#endif
+
+/* maximum number of Active Objects in the application */
+#define FREEACT_MAX_ACTIVE          4U
+
+/* size of event signal [bytes]: 1, 2, or 4 */
+#define FREEACT_SIGNAL_SIZE         1U
+
+#endif /* FREE_ACT_CONFIG_H */
@@ -72,6 +72,29 @@
 #define configTIMER_QUEUE_LENGTH        20
 #define configTIMER_TASK_STACK_DEPTH    ( configMINIMAL_STACK_SIZE * 2 )
 
+/* Tickless idle (release builds only, like the sleep in the idle hook).
+The deepest sleep mode the tick suppression can be timed in is board
+specific: EM2 timed by the RTCC on EFM32PG1B (see bsp_efm32pg1b.c),
+otherwise the Sleep mode timed by the SysTick (FreeRTOS port). */
+#ifdef NDEBUG
+    #ifdef EFM32PG1B200F256GM48
+        #define configUSE_TICKLESS_IDLE 2
+    #else
+        #define configUSE_TICKLESS_IDLE 1
+    #endif
+    /* NOTE: this file is included before portmacro.h defines TickType_t,
+    so the hooks are declared in the macros, where tasks.c expands them
+    (see FreeAct.h for the prototypes). */
+    #define configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING( x ) do { \
+        extern TickType_t FreeAct_sleepBegin( TickType_t expectedIdle ); \
+        ( x ) = FreeAct_sleepBegin( x ); \
+    } while( 0 )
+    #define traceLOW_POWER_IDLE_END() do { \
+        extern void FreeAct_sleepEnd( void ); \
+        FreeAct_sleepEnd(); \
+    } while( 0 )
+#endif
+
 /* Set the following definitions to 1 to include the API function, or zero
 to exclude the API function. */
 
@@ -24,10 +24,12 @@ void BSP_led1_off(void);
 
 enum Signals {
     TIMEOUT_SIG = USER_SIG,
-    BUTTON_PRESSED_SIG,
-    BUTTON_RELEASED_SIG,
+    BUTTONS_SIG, /* debounced buttons changed (Debouncer) */
 };
 
+/* buttons in the debounced input word */
+#define BSP_BUTTON1 (1U << 0)
+
 extern Active *AO_blinkyButton;
 
 #endif /* BSP_H */
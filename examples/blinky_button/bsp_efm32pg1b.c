@@ -13,11 +13,14 @@
 * <info@state-machine.com>
 *****************************************************************************/
 #include "FreeAct.h" /* Free Active Object interface */
+#include "FreeAct_io.h" /* Free Active Object I/O services */
 #include "bsp.h"
 
 #include "em_device.h"  /* the device specific header (SiLabs) */
 #include "em_cmu.h"     /* Clock Management Unit (SiLabs) */
 #include "em_gpio.h"    /* GPIO (SiLabs) */
+#include "em_emu.h"     /* Energy Management Unit (SiLabs) */
+#include "em_rtcc.h"    /* Real Time Counter and Calendar (SiLabs) */
 /* add other drivers if necessary... */
 
 /* LEDs and Push-buttons on the EMF32-SLSTK3401A board ---------------------*/
@@ -41,6 +44,12 @@ void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
 void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
                                     StackType_t **ppxTimerTaskStackBuffer,
                                     uint32_t *pulTimerTaskStackSize);
+void GPIO_EVEN_IRQHandler(void);
+void RTCC_IRQHandler(void);
+
+/* debouncing of the buttons, see vApplicationTickHook() */
+static Debouncer l_buttons;
+static uint32_t l_buttonsSto[DEBOUNCER_STO_SIZE(1U, 2U)];
 
 /* Hooks ===================================================================*/
 /* Application hooks used in this project ==================================*/
@@ -48,39 +57,15 @@ void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
 void vApplicationTickHook(void) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    /* state of the button debouncing, see below */
-    static struct ButtonsDebouncing {
-        uint32_t depressed;
-        uint32_t previous;
-    } buttons = { 0U, 0U };
-    uint32_t current;
-    uint32_t tmp;
-
-    /* Perform the debouncing of buttons. The algorithm for debouncing
-    * adapted from the book "Embedded Systems Dictionary" by Jack Ganssle
-    * and Michael Barr, page 71.
+    /* Perform the debouncing of buttons. The port word is mapped to the
+    * BSP_BUTTON* bits, so that the AO does not depend on the board pins.
     */
-    current = ~GPIO->P[PB_PORT].DIN; /* read PB0 and BP1 */
-    tmp = buttons.depressed; /* save the debounced depressed buttons */
-    buttons.depressed |= (buttons.previous & current); /* set depressed */
-    buttons.depressed &= (buttons.previous | current); /* clear released */
-    buttons.previous   = current; /* update the history */
-    tmp ^= buttons.depressed;     /* changed debounced depressed */
-
-    if ((tmp & (1U << PB0_PIN)) != 0U) {  /* debounced PB0 state changed? */
-        if ((buttons.depressed & (1U << PB0_PIN)) != 0U) { /* PB0 depressed? */
-            /* post the "button-pressed" event from ISR */
-            static Event const buttonPressedEvt = {BUTTON_PRESSED_SIG};
-            Active_postFromISR(AO_blinkyButton, &buttonPressedEvt,
-                               &xHigherPriorityTaskWoken);
-        }
-        else { /* the button is released */
-             /* post the "button-released" event from ISR */
-             static Event const buttonReleasedEvt = {BUTTON_RELEASED_SIG};
-             Active_postFromISR(AO_blinkyButton, &buttonReleasedEvt,
-                                 &xHigherPriorityTaskWoken);
-        }
-    }
+    uint32_t current = ~GPIO->P[PB_PORT].DIN; /* read PB0 and PB1 */
+    current = ((current & (1U << PB0_PIN)) != 0U) ? BSP_BUTTON1 : 0U;
+    Debouncer_tickFromISR(&l_buttons, &current, &xHigherPriorityTaskWoken);
+
+    /* process the FreeACT time base and time events */
+    TimeEvent_tickFromISR(&xHigherPriorityTaskWoken);
 
     /* notify FreeRTOS to perform context switch from ISR, if needed */
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
@@ -88,13 +73,102 @@ void vApplicationTickHook(void) {
 /*..........................................................................*/
 void vApplicationIdleHook(void) {
 #ifdef NDEBUG
-    /* Put the CPU and peripherals to the low-power mode.
-    * you might need to customize the clock management for your application,
-    * see the datasheet for your particular Cortex-M3 MCU.
+    /* The long sleeps are in the tickless idle (see FreeAct_onSleep()).
+    * Whenever the kernel does not suppress the tick (buttons settling,
+    * short idle time, or a timed post due), wait for the next interrupt
+    * in EM1.
     */
     __WFI(); /* Wait-For-Interrupt */
 #endif
 }
+/*..........................................................................*/
+#if (configUSE_TICKLESS_IDLE != 0)
+/* tickless idle: the buttons need the tick only while they are settling */
+TickType_t FreeAct_onSleep(TickType_t expectedIdle) {
+    if (Debouncer_isSettled(&l_buttons) == pdFALSE) {
+        return 0U; /* keep ticking */
+    }
+    /* wake up on any edge of the button, see GPIO_EVEN_IRQHandler() */
+    GPIO_IntClear(1U << PB0_PIN);
+    GPIO_IntEnable(1U << PB0_PIN);
+    return expectedIdle;
+}
+/*..........................................................................*/
+void GPIO_EVEN_IRQHandler(void) {
+    GPIO_IntDisable(1U << PB0_PIN); /* the tick samples the button again */
+    GPIO_IntClear(1U << PB0_PIN);
+    Debouncer_edgeFromISR(&l_buttons);
+}
+#endif /* configUSE_TICKLESS_IDLE */
+
+#if (configUSE_TICKLESS_IDLE == 2)
+/*..........................................................................*/
+/* EM2 tickless idle. The SysTick stops in EM2, so the sleep is timed by
+* the RTCC running from the LFXO (32768 Hz), which also wakes up the CPU.
+* NOTE: the part of the tick elapsed before the sleep is not accounted for,
+* so the kernel time can lag by up to one tick per sleep.
+*/
+#define RTCC_HZ 32768U
+
+void vPortSuppressTicksAndSleep(TickType_t xExpectedIdleTime) {
+    uint32_t start;
+    uint32_t elapsed;
+    TickType_t ticks;
+
+    /* limit the sleep, so the RTCC counts never overflow the computation */
+    if (xExpectedIdleTime > (0xFFFFFFFFU / RTCC_HZ)) {
+        xExpectedIdleTime = (0xFFFFFFFFU / RTCC_HZ);
+    }
+
+    /* disable the interrupts, but still let them wake up the CPU */
+    __disable_irq();
+    __DSB();
+    __ISB();
+
+    /* abandon the sleep if a context switch is pending */
+    if (eTaskConfirmSleepModeStatus() == eAbortSleep) {
+        __enable_irq();
+        return;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk; /* stop the tick */
+
+    start = RTCC_CounterGet();
+    RTCC_ChannelCCVSet(1, start
+        + (uint32_t)(((uint64_t)xExpectedIdleTime * RTCC_HZ)
+                     / configTICK_RATE_HZ));
+    RTCC_IntClear(RTCC_IF_CC1);
+    RTCC_IntEnable(RTCC_IEN_CC1);
+
+    EMU_EnterEM2(true); /* restore the HF clocks upon the wake-up */
+
+    elapsed = RTCC_CounterGet() - start;
+    RTCC_IntDisable(RTCC_IEN_CC1);
+    RTCC_IntClear(RTCC_IF_CC1);
+    NVIC_ClearPendingIRQ(RTCC_IRQn);
+
+    /* step the kernel over the complete ticks slept. When the whole
+    * expected idle time has passed, the last tick is a real one (pended),
+    * so it runs the tick hook and unblocks the tasks, as in the FreeRTOS port
+    */
+    ticks = (TickType_t)(((uint64_t)elapsed * configTICK_RATE_HZ) / RTCC_HZ);
+    if (ticks >= xExpectedIdleTime) {
+        ticks = xExpectedIdleTime - 1U;
+        SCB->ICSR = SCB_ICSR_PENDSTSET_Msk;
+    }
+    vTaskStepTick(ticks);
+
+    SysTick->VAL = 0U; /* restart a full tick period */
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __enable_irq(); /* the wake-up interrupt (if any) runs now */
+}
+/*..........................................................................*/
+void RTCC_IRQHandler(void) {
+    RTCC_IntClear(RTCC_IF_CC1); /* the wake-up only */
+}
+#endif /* configUSE_TICKLESS_IDLE == 2 */
+
 /*..........................................................................*/
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
     (void)xTask;
@@ -193,6 +267,31 @@ void BSP_init(void) {
     /* configure the Buttons */
     GPIO_PinModeSet(PB_PORT, PB0_PIN, gpioModeInputPull, 1);
     GPIO_PinModeSet(PB_PORT, PB1_PIN, gpioModeInputPull, 1);
+
+    /* debounce the buttons for the BlinkyButton AO (see the tick hook) */
+    Debouncer_ctor(&l_buttons, BUTTONS_SIG, AO_blinkyButton,
+                   l_buttonsSto, 1U, 2U);
+
+#if (configUSE_TICKLESS_IDLE != 0)
+    /* both edges of PB0 wake up from the tickless idle (disabled for now) */
+    GPIO_ExtIntConfig(PB_PORT, PB0_PIN, PB0_PIN, true, true, false);
+#endif
+#if (configUSE_TICKLESS_IDLE == 2)
+    {
+        /* the RTCC times the EM2 sleeps, see vPortSuppressTicksAndSleep() */
+        RTCC_Init_TypeDef rtccInit = RTCC_INIT_DEFAULT;
+        RTCC_CCChConf_TypeDef ccInit = RTCC_CH_INIT_COMPARE_DEFAULT;
+
+        CMU_OscillatorEnable(cmuOsc_LFXO, true, true);
+        CMU_ClockSelectSet(cmuClock_LFE, cmuSelect_LFXO);
+        CMU_ClockEnable(cmuClock_HFLE, true);
+        CMU_ClockEnable(cmuClock_RTCC, true);
+
+        rtccInit.presc = rtccCntPresc_1; /* count at 32768 Hz */
+        RTCC_ChannelInit(1, &ccInit);
+        RTCC_Init(&rtccInit);
+    }
+#endif
 }
 /*..........................................................................*/
 void BSP_led0_off(void) {
@@ -220,9 +319,19 @@ void BSP_start(void) {
 
     /* set priorities of ALL ISRs used in the system, see NOTE1 */
     NVIC_SetPriority(SysTick_IRQn, 1U + configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    NVIC_SetPriority(GPIO_EVEN_IRQn,
+        configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8U - __NVIC_PRIO_BITS));
+    NVIC_SetPriority(RTCC_IRQn,
+        configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8U - __NVIC_PRIO_BITS));
     /* ... */
 
     /* enable IRQs... */
+#if (configUSE_TICKLESS_IDLE != 0)
+    NVIC_EnableIRQ(GPIO_EVEN_IRQn);
+#endif
+#if (configUSE_TICKLESS_IDLE == 2)
+    NVIC_EnableIRQ(RTCC_IRQn);
+#endif
     /* ... */
 }
 /*..........................................................................*/
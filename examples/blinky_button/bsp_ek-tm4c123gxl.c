@@ -13,6 +13,7 @@
 * <info@state-machine.com>
 *****************************************************************************/
 #include "FreeAct.h" /* Free Active Object interface */
+#include "FreeAct_io.h" /* Free Active Object I/O services */
 #include "bsp.h"
 
 #include "TM4C123GH6PM.h" /* the TM4C MCU Peripheral Access Layer (TI) */
@@ -35,6 +36,12 @@ void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
 void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
                                     StackType_t **ppxTimerTaskStackBuffer,
                                     uint32_t *pulTimerTaskStackSize);
+void GPIOPortF_IRQHandler(void);
+void TIMER0A_IRQHandler(void);
+
+/* debouncing of the buttons, see vApplicationTickHook() */
+static Debouncer l_buttons;
+static uint32_t l_buttonsSto[DEBOUNCER_STO_SIZE(1U, 2U)];
 
 /* Hooks ===================================================================*/
 /* Application hooks used in this project ==================================*/
@@ -42,39 +49,15 @@ void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
 void vApplicationTickHook(void) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    /* state of the button debouncing, see below */
-    static struct ButtonsDebouncing {
-        uint32_t depressed;
-        uint32_t previous;
-    } buttons = { 0U, 0U };
-    uint32_t current;
-    uint32_t tmp;
-
-    /* Perform the debouncing of buttons. The algorithm for debouncing
-    * adapted from the book "Embedded Systems Dictionary" by Jack Ganssle
-    * and Michael Barr, page 71.
+    /* Perform the debouncing of buttons. The port word is mapped to the
+    * BSP_BUTTON* bits, so that the AO does not depend on the board pins.
     */
-    current = ~GPIOF_AHB->DATA_Bits[BTN_SW1]; /* read SW1 */
-    tmp = buttons.depressed; /* save the debounced depressed buttons */
-    buttons.depressed |= (buttons.previous & current); /* set depressed */
-    buttons.depressed &= (buttons.previous | current); /* clear released */
-    buttons.previous   = current; /* update the history */
-    tmp ^= buttons.depressed;     /* changed debounced depressed */
-
-    if ((tmp & BTN_SW1) != 0U) {  /* debounced SW1 state changed? */
-        if ((buttons.depressed & BTN_SW1) != 0U) { /* is SW1 depressed? */
-            /* post the "button-pressed" event from ISR */
-            static Event const buttonPressedEvt = {BUTTON_PRESSED_SIG};
-            Active_postFromISR(AO_blinkyButton, &buttonPressedEvt,
-                               &xHigherPriorityTaskWoken);
-        }
-        else { /* the button is released */
-             /* post the "button-released" event from ISR */
-             static Event const buttonReleasedEvt = {BUTTON_RELEASED_SIG};
-             Active_postFromISR(AO_blinkyButton, &buttonReleasedEvt,
-                                 &xHigherPriorityTaskWoken);
-        }
-    }
+    uint32_t current = ~GPIOF_AHB->DATA_Bits[BTN_SW1]; /* read SW1 */
+    current = ((current & BTN_SW1) != 0U) ? BSP_BUTTON1 : 0U;
+    Debouncer_tickFromISR(&l_buttons, &current, &xHigherPriorityTaskWoken);
+
+    /* process the FreeACT time base and time events */
+    TimeEvent_tickFromISR(&xHigherPriorityTaskWoken);
 
     /* notify FreeRTOS to perform context switch from ISR, if needed */
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
@@ -82,13 +65,71 @@ void vApplicationTickHook(void) {
 /*..........................................................................*/
 void vApplicationIdleHook(void) {
 #ifdef NDEBUG
-    /* Put the CPU and peripherals to the low-power mode.
-    * you might need to customize the clock management for your application,
-    * see the datasheet for your particular Cortex-M3 MCU.
+    /* The long sleeps are in the tickless idle (see FreeAct_onSleep()).
+    * Whenever the kernel does not suppress the tick (buttons settling,
+    * short idle time, or a timed post due), wait for the next interrupt
+    * in the Sleep mode.
     */
     __WFI(); /* Wait-For-Interrupt */
 #endif
 }
+/*..........................................................................*/
+#if (configUSE_TICKLESS_IDLE != 0)
+/* tickless idle: the buttons need the tick only while they are settling
+* NOTE: the SysTick times the tick suppression, so the deepest mode safe
+* to sleep in is the Sleep mode entered by the FreeRTOS port.
+*/
+TickType_t FreeAct_onSleep(TickType_t expectedIdle) {
+    if (Debouncer_isSettled(&l_buttons) == pdFALSE) {
+        return 0U; /* keep ticking */
+    }
+    /* wake up on any edge of the switch, see GPIOPortF_IRQHandler() */
+    GPIOF_AHB->ICR = BTN_SW1;
+    GPIOF_AHB->IM |= BTN_SW1;
+    return expectedIdle;
+}
+/*..........................................................................*/
+void GPIOPortF_IRQHandler(void) {
+    GPIOF_AHB->IM &= ~BTN_SW1; /* the tick samples the switch again */
+    GPIOF_AHB->ICR = BTN_SW1;
+    Debouncer_edgeFromISR(&l_buttons);
+}
+#endif /* configUSE_TICKLESS_IDLE */
+
+#if (FREEACT_HR_TIMER != 0)
+/*..........................................................................*/
+/* high-resolution TimeEvents: TIMER0 (32-bit) counts up at the CPU clock,
+* the match interrupt fires at the nearest deadline
+*/
+uint32_t FreeAct_hrNow(void) {
+    return TIMER0->TAV;
+}
+/*..........................................................................*/
+uint32_t FreeAct_hrFreq(void) {
+    return SystemCoreClock;
+}
+/*..........................................................................*/
+void FreeAct_hrSetCompare(uint32_t at) {
+    TIMER0->TAMATCHR = at;
+    TIMER0->IMR |= (1U << 4); /* TAMIM: match interrupt */
+    if ((int32_t)(at - TIMER0->TAV) <= 0) { /* missed already? */
+        NVIC_SetPendingIRQ(TIMER0A_IRQn);
+    }
+}
+/*..........................................................................*/
+void FreeAct_hrStop(void) {
+    TIMER0->IMR &= ~(1U << 4);
+}
+/*..........................................................................*/
+void TIMER0A_IRQHandler(void) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    TIMER0->ICR = (1U << 4); /* TAMCINT: clear the match interrupt */
+    HrTimeEvent_compareFromISR(&xHigherPriorityTaskWoken);
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+#endif /* FREEACT_HR_TIMER */
+
 /*..........................................................................*/
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
     (void)xTask;
@@ -167,6 +208,29 @@ void BSP_init(void) {
     GPIOF_AHB->DEN |= BTN_SW1; /* digital enable */
     GPIOF_AHB->PUR |= BTN_SW1; /* pull-up resistor enable */
 
+    /* debounce the buttons for the BlinkyButton AO (see the tick hook) */
+    Debouncer_ctor(&l_buttons, BUTTONS_SIG, AO_blinkyButton,
+                   l_buttonsSto, 1U, 2U);
+
+#if (configUSE_TICKLESS_IDLE != 0)
+    /* both edges of SW1 wake up from the tickless idle (masked for now) */
+    GPIOF_AHB->IS  &= ~BTN_SW1; /* edge-sensitive */
+    GPIOF_AHB->IBE |= BTN_SW1;  /* both edges */
+    GPIOF_AHB->IM  &= ~BTN_SW1;
+#endif
+
+#if (FREEACT_HR_TIMER != 0)
+    /* TIMER0 free-running for the high-resolution TimeEvents */
+    SYSCTL->RCGCTIMER |= (1U << 0); /* enable Run mode for TIMER0 */
+    TIMER0->CTL   = 0U;             /* disabled while configuring */
+    TIMER0->CFG   = 0U;             /* 32-bit (concatenated) timer */
+    TIMER0->TAMR  = 0x02U           /* periodic */
+                    | (1U << 4)     /* TACDIR: count up */
+                    | (1U << 5);    /* TAMIE: match interrupt */
+    TIMER0->TAILR = 0xFFFFFFFFU;    /* full 32-bit range */
+    TIMER0->IMR   = 0U;             /* no deadline yet */
+    TIMER0->CTL   = (1U << 0);      /* TAEN: start counting */
+#endif
 }
 /*..........................................................................*/
 void BSP_led0_off(void) {
@@ -194,9 +258,19 @@ void BSP_start(void) {
 
     /* set priorities of ALL ISRs used in the system, see NOTE1 */
     NVIC_SetPriority(SysTick_IRQn, 1U + configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    NVIC_SetPriority(GPIOF_IRQn,
+        configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8U - __NVIC_PRIO_BITS));
+    NVIC_SetPriority(TIMER0A_IRQn,
+        configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8U - __NVIC_PRIO_BITS));
     /* ... */
 
     /* enable IRQs... */
+#if (configUSE_TICKLESS_IDLE != 0)
+    NVIC_EnableIRQ(GPIOF_IRQn);
+#endif
+#if (FREEACT_HR_TIMER != 0)
+    NVIC_EnableIRQ(TIMER0A_IRQn);
+#endif
     /* ... */
 }
 /*..........................................................................*/
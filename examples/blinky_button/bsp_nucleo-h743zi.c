@@ -11,6 +11,7 @@
 * SPDX-License-Identifier: MIT
 ============================================================================*/
 #include "FreeAct.h" /* Free Active Object interface */
+#include "FreeAct_io.h" /* Free Active Object I/O services */
 #include "bsp.h"
 
 #include "stm32h743xx.h"  /* CMSIS-compliant header file for the MCU used */
@@ -37,6 +38,12 @@ void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
 void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
                                     StackType_t **ppxTimerTaskStackBuffer,
                                     uint32_t *pulTimerTaskStackSize);
+void EXTI15_10_IRQHandler(void);
+void TIM2_IRQHandler(void);
+
+/* debouncing of the buttons, see vApplicationTickHook() */
+static Debouncer l_buttons;
+static uint32_t l_buttonsSto[DEBOUNCER_STO_SIZE(1U, 2U)];
 
 /* Hooks ===================================================================*/
 /* Application hooks used in this project ==================================*/
@@ -44,38 +51,15 @@ void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
 void vApplicationTickHook(void) {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    /* Perform the debouncing of buttons. The algorithm for debouncing
-    * adapted from the book "Embedded Systems Dictionary" by Jack Ganssle
-    * and Michael Barr, page 71.
-    */
-    /* Perform the debouncing of buttons. The algorithm for debouncing
-    * adapted from the book "Embedded Systems Dictionary" by Jack Ganssle
-    * and Michael Barr, page 71.
+    /* Perform the debouncing of buttons. The port word is mapped to the
+    * BSP_BUTTON* bits, so that the AO does not depend on the board pins.
     */
-    static struct ButtonsDebouncing {
-        uint32_t depressed;
-        uint32_t previous;
-    } buttons = { 0U, 0U };
     uint32_t current = GPIOC->IDR; /* read GPIO PortC */
-    uint32_t tmp = buttons.depressed; /* save the debounced depressed */
-    buttons.depressed |= (buttons.previous & current); /* set depressed */
-    buttons.depressed &= (buttons.previous | current); /* clear released */
-    buttons.previous   = current; /* update the history */
-    tmp ^= buttons.depressed;     /* changed debounced depressed */
-    if ((tmp & (1U << B1_PIN)) != 0U) { /* debounced B1 state changed? */
-        if ((buttons.depressed & (1U << B1_PIN)) != 0U) { /* depressed? */
-            /* post the "button-pressed" event from ISR */
-            static Event const buttonPressedEvt = {BUTTON_PRESSED_SIG};
-            Active_postFromISR(AO_blinkyButton, &buttonPressedEvt,
-                               &xHigherPriorityTaskWoken);
-        }
-        else { /* the button is released */
-             /* post the "button-released" event from ISR */
-             static Event const buttonReleasedEvt = {BUTTON_RELEASED_SIG};
-             Active_postFromISR(AO_blinkyButton, &buttonReleasedEvt,
-                                 &xHigherPriorityTaskWoken);
-        }
-    }
+    current = ((current & (1U << B1_PIN)) != 0U) ? BSP_BUTTON1 : 0U;
+    Debouncer_tickFromISR(&l_buttons, &current, &xHigherPriorityTaskWoken);
+
+    /* process the FreeACT time base and time events */
+    TimeEvent_tickFromISR(&xHigherPriorityTaskWoken);
 
     /* notify FreeRTOS to perform context switch from ISR, if needed */
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
@@ -83,13 +67,77 @@ void vApplicationTickHook(void) {
 /*..........................................................................*/
 void vApplicationIdleHook(void) {
 #ifdef NDEBUG
-    /* Put the CPU and peripherals to the low-power mode.
-    * you might need to customize the clock management for your application,
-    * see the datasheet for your particular Cortex-M3 MCU.
+    /* The long sleeps are in the tickless idle (see FreeAct_onSleep()).
+    * Whenever the kernel does not suppress the tick (buttons settling,
+    * short idle time, or a timed post due), wait for the next interrupt
+    * in the CSleep mode.
     */
     __WFI(); /* Wait-For-Interrupt */
 #endif
 }
+/*..........................................................................*/
+#if (configUSE_TICKLESS_IDLE != 0)
+/* tickless idle: the buttons need the tick only while they are settling
+* NOTE: the SysTick stops in the Stop mode, so the deepest mode safe
+* to sleep in is the CSleep mode entered by the FreeRTOS port.
+*/
+TickType_t FreeAct_onSleep(TickType_t expectedIdle) {
+    if (Debouncer_isSettled(&l_buttons) == pdFALSE) {
+        return 0U; /* keep ticking */
+    }
+    /* wake up on any edge of the button, see EXTI15_10_IRQHandler() */
+    EXTI_D1->PR1   = (1U << B1_PIN);
+    EXTI_D1->IMR1 |= (1U << B1_PIN);
+    return expectedIdle;
+}
+/*..........................................................................*/
+void EXTI15_10_IRQHandler(void) {
+    EXTI_D1->IMR1 &= ~(1U << B1_PIN); /* the tick samples the button again */
+    EXTI_D1->PR1   = (1U << B1_PIN);
+    Debouncer_edgeFromISR(&l_buttons);
+}
+#endif /* configUSE_TICKLESS_IDLE */
+
+#if (FREEACT_HR_TIMER != 0)
+/*..........................................................................*/
+/* high-resolution TimeEvents: TIM2 (32-bit) counts up at its kernel clock,
+* the capture/compare 1 interrupt fires at the nearest deadline
+*/
+uint32_t FreeAct_hrNow(void) {
+    return TIM2->CNT;
+}
+/*..........................................................................*/
+uint32_t FreeAct_hrFreq(void) {
+    /* PCLK1, doubled when APB1 is divided (RCC_CFGR.TIMPRE == 0) */
+    uint32_t const ppre = (RCC->D2CFGR & RCC_D2CFGR_D2PPRE1_Msk)
+                          >> RCC_D2CFGR_D2PPRE1_Pos;
+    return (ppre < 4U)
+           ? SystemD2Clock
+           : ((SystemD2Clock >> (ppre - 3U)) * 2U);
+}
+/*..........................................................................*/
+void FreeAct_hrSetCompare(uint32_t at) {
+    TIM2->CCR1 = at;
+    TIM2->SR = ~(uint32_t)TIM_SR_CC1IF;
+    TIM2->DIER |= TIM_DIER_CC1IE;
+    if ((int32_t)(at - TIM2->CNT) <= 0) { /* missed already? */
+        TIM2->EGR = TIM_EGR_CC1G; /* generate the compare event now */
+    }
+}
+/*..........................................................................*/
+void FreeAct_hrStop(void) {
+    TIM2->DIER &= ~TIM_DIER_CC1IE;
+}
+/*..........................................................................*/
+void TIM2_IRQHandler(void) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    TIM2->SR = ~(uint32_t)TIM_SR_CC1IF; /* clear the compare interrupt */
+    HrTimeEvent_compareFromISR(&xHigherPriorityTaskWoken);
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+#endif /* FREEACT_HR_TIMER */
+
 /*..........................................................................*/
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
     (void)xTask;
@@ -201,6 +249,33 @@ void BSP_init(void) {
     GPIOC->MODER   &= ~(3U << 2U*B1_PIN);
     GPIOC->PUPDR   &= ~(GPIO_PUPDR_PUPD0 << 2U*B1_PIN);
     GPIOC->PUPDR   |=  (2U << 2U*B1_PIN);
+
+    /* debounce the buttons for the BlinkyButton AO (see the tick hook) */
+    Debouncer_ctor(&l_buttons, BUTTONS_SIG, AO_blinkyButton,
+                   l_buttonsSto, 1U, 2U);
+
+#if (configUSE_TICKLESS_IDLE != 0)
+    /* both edges of B1 wake up from the tickless idle (masked for now) */
+    RCC->APB4ENR |= RCC_APB4ENR_SYSCFGEN;
+    SYSCFG->EXTICR[3] = (SYSCFG->EXTICR[3] & ~SYSCFG_EXTICR4_EXTI13)
+                        | SYSCFG_EXTICR4_EXTI13_PC;
+    EXTI->RTSR1 |= (1U << B1_PIN);
+    EXTI->FTSR1 |= (1U << B1_PIN);
+    EXTI_D1->IMR1 &= ~(1U << B1_PIN);
+#endif
+
+#if (FREEACT_HR_TIMER != 0)
+    /* TIM2 free-running for the high-resolution TimeEvents */
+    RCC->APB1LENR |= RCC_APB1LENR_TIM2EN;
+    TIM2->CR1  = 0U;            /* disabled while configuring, count up */
+    TIM2->PSC  = 0U;            /* the kernel clock, see FreeAct_hrFreq() */
+    TIM2->ARR  = 0xFFFFFFFFU;   /* full 32-bit range */
+    TIM2->CCMR1 = 0U;           /* CC1: frozen output compare */
+    TIM2->DIER = 0U;            /* no deadline yet */
+    TIM2->EGR  = TIM_EGR_UG;    /* load the prescaler */
+    TIM2->SR   = 0U;
+    TIM2->CR1  = TIM_CR1_CEN;   /* start counting */
+#endif
 }
 /*..........................................................................*/
 void BSP_led0_off(void) {
@@ -224,7 +299,19 @@ void BSP_start(void) {
     /* SysTick_Config(SystemCoreClock / BSP_TICKS_PER_SEC); done in FreeRTOS */
 
     /* set priorities of ISRs used in the system */
+    NVIC_SetPriority(EXTI15_10_IRQn,
+        configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8U - __NVIC_PRIO_BITS));
+    NVIC_SetPriority(TIM2_IRQn,
+        configMAX_SYSCALL_INTERRUPT_PRIORITY >> (8U - __NVIC_PRIO_BITS));
     /* ... */
+
+    /* enable IRQs... */
+#if (configUSE_TICKLESS_IDLE != 0)
+    NVIC_EnableIRQ(EXTI15_10_IRQn);
+#endif
+#if (FREEACT_HR_TIMER != 0)
+    NVIC_EnableIRQ(TIM2_IRQn);
+#endif
 }
 /*..........................................................................*/
 /* error-handling function called by exception handlers in the startup code */
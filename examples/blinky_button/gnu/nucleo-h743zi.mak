@@ -87,6 +87,7 @@ CPP_SRCS :=
 
 FREEACT_SRCS := \
 	FreeAct.c \
+	FreeAct_io.c \
 	list.c \
 	queue.c \
 	tasks.c \
@@ -105,6 +106,12 @@ LIBS      :=
 # defines
 DEFINES   := -DSTM32H743xx
 
+# critical-section profiler (make CS_PROF=1), see FREEACT_CS_PROF
+ifneq ($(CS_PROF),)
+DEFINES   += -DFREEACT_CS_PROF=1
+CS_WRAP   := -Wl,--wrap=vPortEnterCritical,--wrap=vPortExitCritical
+endif
+
 # ARM CPU, ARCH, FPU, and Float-ABI types...
 # ARM_CPU:   [cortex-m0 | cortex-m0plus | cortex-m1 | cortex-m3 | cortex-m4]
 # ARM_FPU:   [ | vfp]
@@ -158,13 +165,17 @@ CFLAGS = -c -g $(ARM_CPU) $(ARM_FPU) $(FLOAT_ABI) -std=c99 -mthumb -Wall \
 	-ffunction-sections -fdata-sections \
 	-O $(INCLUDES) $(DEFINES)
 
-CPPFLAGS = -c -g $(ARM_CPU) $(ARM_FPU) $(FLOAT_ABI) -std=c++11 -mthumb -Wall \
+# C++ standard (make CPP_STD=c++20 for the coroutine AOs of FreeAct_co.hpp)
+CPP_STD ?= c++17
+
+CPPFLAGS = -c -g $(ARM_CPU) $(ARM_FPU) $(FLOAT_ABI) -std=$(CPP_STD) -mthumb -Wall \
 	-ffunction-sections -fdata-sections -fno-rtti -fno-exceptions \
 	-O $(INCLUDES) $(DEFINES)
 
 LINKFLAGS = -T$(LD_SCRIPT) $(ARM_CPU) $(ARM_FPU) $(FLOAT_ABI) -mthumb \
 	-specs=nosys.specs -specs=nano.specs \
-	-Wl,-Map,$(BIN_DIR)/$(OUTPUT).map,--cref,--gc-sections $(LIB_DIRS)
+	-Wl,-Map,$(BIN_DIR)/$(OUTPUT).map,--cref,--gc-sections $(LIB_DIRS) \
+	$(CS_WRAP)
 
 ASM_OBJS     := $(patsubst %.s,%.o,  $(notdir $(ASM_SRCS)))
 C_OBJS       := $(patsubst %.c,%.o,  $(notdir $(C_SRCS)))
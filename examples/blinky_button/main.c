@@ -13,6 +13,7 @@
 * <info@state-machine.com>
 *****************************************************************************/
 #include "FreeAct.h" /* Free Active Object interface */
+#include "FreeAct_io.h" /* Free Active Object I/O services */
 #include "bsp.h"
 #include <stdbool.h>
 
@@ -43,12 +44,18 @@ static void BlinkyButton_dispatch(BlinkyButton * const me, Event const * const e
             }
             break;
         }
-        case BUTTON_PRESSED_SIG: {
-            BSP_led1_on();
-            break;
-        }
-        case BUTTON_RELEASED_SIG: {
-            BSP_led1_off();
+        case BUTTONS_SIG: {
+            uint32_t changed;
+            uint32_t state;
+            Debouncer_read(e, &changed, &state);
+            if ((changed & BSP_BUTTON1) != 0U) {
+                if ((state & BSP_BUTTON1) != 0U) { /* pressed? */
+                    BSP_led1_on();
+                }
+                else { /* released */
+                    BSP_led1_off();
+                }
+            }
             break;
         }
         default: {
@@ -58,12 +65,11 @@ static void BlinkyButton_dispatch(BlinkyButton * const me, Event const * const e
 }
 void BlinkyButton_ctor(BlinkyButton * const me) {
     Active_ctor(&me->super, (DispatchHandler)&BlinkyButton_dispatch);
-    me->te.type = TYPE_ONE_SHOT;
     TimeEvent_ctor(&me->te, TIMEOUT_SIG, &me->super);
     me->isLedOn = false;
 }
 static StackType_t blinkyButton_stack[configMINIMAL_STACK_SIZE]; /* task stack */
-static Event *blinkyButton_queue[10];
+static ActiveQueueSlot blinkyButton_queue[10];
 static BlinkyButton blinkyButton;
 Active *AO_blinkyButton = &blinkyButton.super;
 
@@ -0,0 +1,38 @@
+/*****************************************************************************
+* FreeAct configuration for the POSIX host examples
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2023 Quantum Leaps, LLC. All rights reserved.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_CONFIG_H
+#define FREE_ACT_CONFIG_H
+
+/* The defaults for all settings are in FreeAct.h. Override only
+* what the application needs to be different.
+*/
+
+/* assertions: 0 - none, 1 - API and resource checks, 2 - all (default) */
+#define FREEACT_ASSERT_LEVEL        2
+
+/* AO event queues: earliest-deadline-first (see edf_bench.c) */
+#define FREEACT_QUEUE               FREEACT_QUEUE_EDF
+
+/* the POSIX port has no xPortIsInsideInterrupt(), so the tick hook
+* must call the explicit "FromISR" variants
+*/
+#define FREEACT_ISR_DETECT          0
+
+/* high-resolution TimeEvents on the timerfd stand-in (see hr_test.c) */
+#define FREEACT_HR_TIMER            1
+
+/* maximum number of Active Objects in the application */
+#define FREEACT_MAX_ACTIVE          4U
+
+#endif /* FREE_ACT_CONFIG_H */
@@ -0,0 +1,96 @@
+/* Modified by Quantum Leaps
+ */
+/*
+ * FreeRTOS Kernel V10.0.1
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+ * Application specific definitions for the FreeRTOS POSIX port
+ * (portable/ThirdParty/GCC/Posix), where the tasks are threads and the
+ * tick is a signal of the interval timer.
+ *
+ * See http://www.freertos.org/a00110.html.
+ *----------------------------------------------------------*/
+
+#define configUSE_PREEMPTION            1
+#define configUSE_IDLE_HOOK             0
+#define configUSE_TICK_HOOK             1
+#define configTICK_RATE_HZ              ( ( TickType_t ) 1000 )
+/* the task stacks are the thread stacks, so at least PTHREAD_STACK_MIN
+ * bytes (128KB on some 64-bit hosts); StackType_t is 'unsigned long' */
+#define configMINIMAL_STACK_SIZE        ( ( unsigned short ) 0x4000 )
+#define configTOTAL_HEAP_SIZE           ( ( size_t ) ( 0 ) )
+#define configMAX_TASK_NAME_LEN         ( 8 )
+#define configUSE_TRACE_FACILITY        0
+#define configUSE_16_BIT_TICKS          0
+#define configIDLE_SHOULD_YIELD         1
+#define configUSE_CO_ROUTINES           0
+#define configUSE_MUTEXES               1
+#define configUSE_RECURSIVE_MUTEXES     1
+#define configCHECK_FOR_STACK_OVERFLOW  0
+#define configUSE_QUEUE_SETS            0
+#define configUSE_COUNTING_SEMAPHORES   1
+
+#define configMAX_PRIORITIES            ( 8UL )
+#define configMAX_CO_ROUTINE_PRIORITIES ( 2 )
+#define configQUEUE_REGISTRY_SIZE       0
+#define configSUPPORT_DYNAMIC_ALLOCATION 0
+#define configSUPPORT_STATIC_ALLOCATION  1
+
+/* Timer related defines (the TimeEvents preempt all AOs). */
+#define configUSE_TIMERS                1
+#define configTIMER_TASK_PRIORITY       ( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH        20
+#define configTIMER_TASK_STACK_DEPTH    configMINIMAL_STACK_SIZE
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+
+#define INCLUDE_vTaskPrioritySet        0
+#define INCLUDE_uxTaskPriorityGet       0
+#define INCLUDE_vTaskDelete             1
+#define INCLUDE_vTaskCleanUpResources   0
+#define INCLUDE_vTaskSuspend            1
+#define INCLUDE_vTaskDelayUntil         0
+#define INCLUDE_vTaskDelay              1
+#define INCLUDE_uxTaskGetStackHighWaterMark    0
+#define INCLUDE_xTaskGetSchedulerState         1
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle 0
+#define INCLUDE_xTaskGetIdleTaskHandle         0
+#define INCLUDE_xSemaphoreGetMutexHolder       1
+#define INCLUDE_eTaskGetState                  1
+#define INCLUDE_xTimerPendFunctionCall         0
+
+/* The POSIX port selects the tasks with the generic C code. */
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+
+#define configASSERT( x ) if( ( x ) == 0 ) assert_failed( __FILE__, __LINE__ );
+void assert_failed(char const * const module, int location);
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,24 @@
+/*****************************************************************************
+* Lab Project: FreeAct host programs
+* Board: POSIX host (FreeRTOS POSIX port)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2023 Quantum Leaps, LLC. All rights reserved.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef BSP_H
+#define BSP_H
+
+void BSP_init(void);
+void BSP_exit(int status); /* report done, end the program */
+
+/* busy CPU load of the given duration, e.g., for a long RTC step */
+void BSP_spin(uint32_t us);
+
+#endif /* BSP_H */
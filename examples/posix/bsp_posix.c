@@ -0,0 +1,103 @@
+/*****************************************************************************
+* Lab Project: FreeAct host programs
+* Board: POSIX host (FreeRTOS POSIX port)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2023 Quantum Leaps, LLC. All rights reserved.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "FreeAct.h" /* Free Active Object interface */
+#include "FreeAct_io.h" /* Free Active Object I/O services */
+#include "bsp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Function Prototype ======================================================*/
+void vApplicationTickHook(void);
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize);
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize);
+
+/* Hooks ===================================================================*/
+/* Application hooks used in this project ==================================*/
+/* NOTE: only the "FromISR" API calls are allowed from the ISRs!
+* In the POSIX port the tick "ISR" is the handler of the timer signal.
+*/
+void vApplicationTickHook(void) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    /* process the FreeACT time base and time events */
+    TimeEvent_tickFromISR(&xHigherPriorityTaskWoken);
+
+    /* forward the posts of the native threads (no SWI on the host) */
+    IsrChannel_forwardFromISR(&xHigherPriorityTaskWoken);
+
+    /* notify FreeRTOS to perform context switch from ISR, if needed */
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+/*..........................................................................*/
+/* configSUPPORT_STATIC_ALLOCATION is set to 1, so the application must
+ * provide an implementation of vApplicationGetIdleTaskMemory() to provide
+ * the memory that is used by the Idle task.
+ */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t  uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer   = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = &uxIdleTaskStack[0];
+    *pulIdleTaskStackSize = sizeof(uxIdleTaskStack) / sizeof(uxIdleTaskStack[0]);
+}
+/*..........................................................................*/
+/* configSUPPORT_STATIC_ALLOCATION is set to 1, so the application must
+ * provide an implementation of vApplicationGetTimerTaskMemory() to provide
+ * the memory that is used by the Timer task.
+ */
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+    static StaticTask_t xTimerTask_TCB;
+    static StackType_t  uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTimerTaskTCBBuffer   = &xTimerTask_TCB;
+    *ppxTimerTaskStackBuffer = &uxTimerTaskStack[0];
+    *pulTimerTaskStackSize = sizeof(uxTimerTaskStack) / sizeof(uxTimerTaskStack[0]);
+}
+
+/* BSP functions ===========================================================*/
+void BSP_init(void) {
+    setvbuf(stdout, (char *)0, _IONBF, 0U); /* no buffering of the reports */
+}
+/*..........................................................................*/
+void BSP_exit(int status) {
+    /* NOTE: the POSIX port runs the tasks in threads, so exit() ends the
+    * whole program, including the scheduler
+    */
+    exit(status);
+}
+/*..........................................................................*/
+void BSP_spin(uint32_t us) {
+    FreeAct_Time const end = FreeAct_now() + FREEACT_TIME_US(us);
+    while (FreeAct_now() < end) { /* preemptible busy-wait */
+    }
+}
+/*..........................................................................*/
+/* error-handling function called by configASSERT() */
+void assert_failed(char const * const module, int loc) {
+    fprintf(stderr, "assertion failed in %s:%d\n", module, loc);
+    exit(-1);
+}
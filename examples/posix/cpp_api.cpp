@@ -0,0 +1,136 @@
+/*****************************************************************************
+* Lab Project: compile check of the FreeAct C++ interfaces
+* Board: POSIX host (FreeRTOS POSIX port)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2023 Quantum Leaps, LLC. All rights reserved.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+/* Instantiates the templates of FreeAct.hpp and FreeAct_co.hpp (the CRTP
+* Active, the event pools, the table-driven state machines and the
+* coroutine AOs), so that "make check" compiles them. This file is not
+* part of the host programs and is never run.
+*/
+#include "FreeAct_co.hpp" /* Free Active Object C++20 coroutines */
+
+enum Signals {
+    TIMEOUT_SIG = USER_SIG,
+    BUTTON_SIG,
+    DATA_SIG = USER_SIG + 40, /* far from the others (sparse signals) */
+};
+
+struct ButtonEvt : freeact::TypedEvent<BUTTON_SIG> {
+    std::uint8_t id;
+
+    explicit ButtonEvt(std::uint8_t const i) : id(i) {}
+};
+
+static constexpr std::size_t STACK_BYTES
+    = configMINIMAL_STACK_SIZE * sizeof(StackType_t);
+
+static freeact::EventPool<ButtonEvt, 4U> l_buttonPool;
+
+/* Blinky AO with a dense table-driven state machine =======================*/
+class Blinky : public freeact::Active<Blinky, 8U, STACK_BYTES, 1U>,
+               public freeact::Fsm<Blinky, 2U,
+                          freeact::DenseSignals<TIMEOUT_SIG, 2U>>
+{
+public:
+    enum : std::uint8_t { OFF, ON };
+
+    static void ledOn(Blinky &me, Event const *e)  { ++me.m_toggles; (void)e; }
+    static void ledOff(Blinky &me, Event const *e) { ++me.m_toggles; (void)e; }
+
+    static constexpr Table table = makeTable({
+        { OFF, TIMEOUT_SIG, &ledOn,  ON  },
+        { OFF, BUTTON_SIG,  IGNORED, OFF },
+        { ON,  TIMEOUT_SIG, &ledOff, OFF },
+        { ON,  BUTTON_SIG,  &ledOff, OFF },
+    });
+
+    Blinky() : Fsm(OFF) {}
+
+    void dispatch(Event const * const e) {
+        if (e->sig == BUTTON_SIG) {
+            m_lastId = freeact::event_cast<ButtonEvt>(e)->id;
+        }
+        Fsm::dispatch(e);
+    }
+
+private:
+    std::uint32_t m_toggles = 0U;
+    std::uint8_t m_lastId = 0U;
+};
+
+/* Logger AO with a sparse table-driven state machine ======================*/
+class Logger : public freeact::Active<Logger, 8U, STACK_BYTES, 2U>,
+               public freeact::Fsm<Logger, 1U,
+                          freeact::SparseSignals<BUTTON_SIG, DATA_SIG>>
+{
+public:
+    enum : std::uint8_t { IDLE };
+
+    static void log(Logger &me, Event const *e) { ++me.m_logged; (void)e; }
+
+    static constexpr Table table = makeTable({
+        { IDLE, BUTTON_SIG, &log,    IDLE },
+        { IDLE, DATA_SIG,   IGNORED, IDLE },
+    });
+
+    Logger() : Fsm(IDLE) {}
+
+    void dispatch(Event const * const e) { Fsm::dispatch(e); }
+
+private:
+    std::uint32_t m_logged = 0U;
+};
+
+static Blinky l_blinky;
+static Logger l_logger;
+
+/* coroutine AOs ===========================================================*/
+static freeact::co::Dispatcher<16U, STACK_BYTES, 3U, 512U> l_disp;
+
+class Watchdog : public freeact::co::CoActive<4U> {
+public:
+    Watchdog() : CoActive(l_disp) {}
+
+    freeact::co::Task run() {
+        for (;;) {
+            Event const *e = co_await receive(100U); /* event or timeout */
+            if (e == nullptr) { /* timeout? */
+                ++m_timeouts;
+            }
+            e = co_await receive();
+            (void)e;
+        }
+    }
+
+private:
+    std::uint32_t m_timeouts = 0U;
+};
+
+static Watchdog l_watchdog;
+
+/*..........................................................................*/
+void CppApi_start(void); /* referenced by nothing, keeps the code alive */
+void CppApi_start(void) {
+    static Event const timeoutEvt = { TIMEOUT_SIG };
+
+    l_blinky.start();
+    l_logger.start();
+    l_disp.start(); /* start the Dispatcher first */
+    l_watchdog.start(l_watchdog.run());
+
+    l_blinky.post(&timeoutEvt);
+    auto b = l_buttonPool.make(std::uint8_t{ 1U });
+    l_logger.post(b);            /* keeps the reference */
+    l_blinky.post(std::move(b)); /* hands it off */
+    l_watchdog.post(&timeoutEvt);
+}
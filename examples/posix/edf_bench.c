@@ -0,0 +1,237 @@
+/*****************************************************************************
+* Lab Project: EDF queue benchmark under mixed bulk/urgent load
+* Board: POSIX host (FreeRTOS POSIX port)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2023 Quantum Leaps, LLC. All rights reserved.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+/* The Load AO posts to the Worker AO every LOAD_PERIOD_MS a burst of bulk
+* events (long RTC steps, loose deadline), and one urgent event (short RTC
+* step, tight deadline) a few ticks into the burst, while the Worker still
+* processes the bulk. The same load runs twice: first with the deadlines
+* given to the Worker's earliest-deadline-first queue (Active_postDeadline),
+* then with plain FIFO posts (Active_post) for reference. The Worker checks
+* the deadline carried in each event at the end of its RTC step, so both
+* runs are measured the same way.
+*/
+#include "FreeAct.h" /* Free Active Object interface */
+#include "bsp.h"
+
+#include <stdio.h>
+
+/* the load ================================================================*/
+#define LOAD_PERIODS       100U /* periods per run */
+#define LOAD_PERIOD_MS      20U /* period of the bursts */
+#define BULK_PER_PERIOD      8U /* bulk events per burst */
+#define BULK_WORK_US      1000U /* RTC step of a bulk event */
+#define BULK_DEADLINE_US 20000U /* relative deadline of a bulk event */
+#define URGENT_WORK_US     200U /* RTC step of an urgent event */
+#define URGENT_DEADLINE_US 3000U /* relative deadline of an urgent event */
+#define URGENT_OFFSETS       6U /* urgent post 1..URGENT_OFFSETS ms late */
+
+enum Signals {
+    PERIOD_SIG = USER_SIG, /* next burst (Load) */
+    URGENT_TICK_SIG,       /* time for the urgent post (Load) */
+    BULK_SIG,              /* bulk work (Worker) */
+    URGENT_SIG,            /* urgent work (Worker) */
+};
+
+enum Runs { RUN_EDF, RUN_FIFO, RUN_MAX };
+static char const * const l_runName[RUN_MAX] = { "EDF", "FIFO" };
+
+enum Classes { CLASS_BULK, CLASS_URGENT, CLASS_MAX };
+static char const * const l_className[CLASS_MAX] = { "bulk", "urgent" };
+
+typedef struct {
+    Event super;           /* inherit Event */
+    FreeAct_Time posted;   /* time of the post */
+    FreeAct_Time deadline; /* absolute deadline */
+} WorkEvt;
+
+typedef struct {
+    uint32_t events;       /* events processed */
+    uint32_t missed;       /* events completed after their deadlines */
+    FreeAct_Time maxLatency; /* longest post-to-completion time */
+} ClassStats;
+
+/* The Worker AO ===========================================================*/
+typedef struct {
+    Active super;          /* inherit Active base class */
+    ClassStats stats[CLASS_MAX];
+} Worker;
+
+static void Worker_dispatch(Worker * const me, Event const * const e) {
+    switch (e->sig) {
+        case BULK_SIG: /* intentionally fall through... */
+        case URGENT_SIG: {
+            WorkEvt const * const we = (WorkEvt const *)e;
+            ClassStats * const cs =
+                &me->stats[(e->sig == BULK_SIG) ? CLASS_BULK : CLASS_URGENT];
+            FreeAct_Time now;
+
+            BSP_spin((e->sig == BULK_SIG) ? BULK_WORK_US : URGENT_WORK_US);
+
+            now = FreeAct_now();
+            ++cs->events;
+            if (now > we->deadline) {
+                ++cs->missed;
+            }
+            if (now - we->posted > cs->maxLatency) {
+                cs->maxLatency = now - we->posted;
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+static void Worker_ctor(Worker * const me) {
+    Active_ctor(&me->super, (DispatchHandler)&Worker_dispatch);
+}
+
+static StackType_t worker_stack[configMINIMAL_STACK_SIZE]; /* task stack */
+/* a whole burst fits, with room for the Worker running late */
+static ActiveQueueSlot worker_queue[4U * (BULK_PER_PERIOD + 1U)];
+static Worker worker;
+
+/* The Load AO =============================================================*/
+typedef struct {
+    Active super;          /* inherit Active base class */
+    TimeEvent period;      /* periodic bursts */
+    TimeEvent urgent;      /* the urgent post in the burst */
+    uint8_t run;           /* current run (enum Runs) */
+    uint32_t periods;      /* periods of the current run */
+    uint16_t next;         /* next event in the pool */
+    WorkEvt pool[sizeof(worker_queue) / sizeof(worker_queue[0])];
+} Load;
+
+/* post the next event of the pool (all posts cycle through the pool, so
+* an event is reused only after a whole queue of later posts)
+*/
+static void Load_post(Load * const me, Signal sig, uint32_t deadlineUs) {
+    WorkEvt * const we = &me->pool[me->next];
+
+    ++me->next;
+    if (me->next == (sizeof(me->pool) / sizeof(me->pool[0]))) {
+        me->next = 0U;
+    }
+    we->super.sig = sig;
+    we->posted    = FreeAct_now();
+    we->deadline  = we->posted + FREEACT_TIME_US(deadlineUs);
+    if (me->run == RUN_EDF) {
+        Active_postDeadline(&worker.super, &we->super, we->deadline);
+    }
+    else {
+        Active_post(&worker.super, &we->super);
+    }
+}
+/*..........................................................................*/
+static void Load_report(Load * const me) {
+    uint8_t c;
+
+    for (c = 0U; c < CLASS_MAX; ++c) {
+        ClassStats * const cs = &worker.stats[c];
+        printf("%-5s %-7s %7u %7u %12u\n",
+               l_runName[me->run], l_className[c],
+               (unsigned)cs->events, (unsigned)cs->missed,
+               (unsigned)((cs->maxLatency * 1000000U) / FreeAct_timeFreq()));
+        cs->events     = 0U;
+        cs->missed     = 0U;
+        cs->maxLatency = 0U;
+    }
+}
+/*..........................................................................*/
+static void Load_dispatch(Load * const me, Event const * const e) {
+    switch (e->sig) {
+        case INIT_SIG: {
+            printf("%u periods of %u ms: %u bulk (%u us, deadline %u us) "
+                   "+ 1 urgent (%u us, deadline %u us)\n",
+                   LOAD_PERIODS, LOAD_PERIOD_MS, BULK_PER_PERIOD,
+                   BULK_WORK_US, BULK_DEADLINE_US,
+                   URGENT_WORK_US, URGENT_DEADLINE_US);
+            printf("queue class    events  missed latency[us]\n");
+            TimeEvent_armX(&me->period,
+                           LOAD_PERIOD_MS / portTICK_PERIOD_MS,
+                           LOAD_PERIOD_MS / portTICK_PERIOD_MS);
+            break;
+        }
+        case PERIOD_SIG: {
+            uint8_t i;
+            if (me->periods == LOAD_PERIODS) { /* run over (one idle period
+                                               * drained the Worker)? */
+                Load_report(me);
+                me->periods = 0U;
+                ++me->run;
+                if (me->run == RUN_MAX) {
+                    printf("EDF queue misses (Active.missed): %u\n",
+                           (unsigned)worker.super.missed);
+                    BSP_exit(0);
+                }
+                break; /* this period stays idle */
+            }
+            for (i = 0U; i < BULK_PER_PERIOD; ++i) {
+                Load_post(me, BULK_SIG, BULK_DEADLINE_US);
+            }
+            /* the urgent post lands in the burst at a varying point */
+            TimeEvent_arm(&me->urgent,
+                          1U + (me->periods % URGENT_OFFSETS));
+            ++me->periods;
+            break;
+        }
+        case URGENT_TICK_SIG: {
+            Load_post(me, URGENT_SIG, URGENT_DEADLINE_US);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+static void Load_ctor(Load * const me) {
+    Active_ctor(&me->super, (DispatchHandler)&Load_dispatch);
+    TimeEvent_ctor(&me->period, PERIOD_SIG, &me->super);
+    TimeEvent_ctor(&me->urgent, URGENT_TICK_SIG, &me->super);
+    me->run     = RUN_EDF;
+    me->periods = 0U;
+    me->next    = 0U;
+}
+
+static StackType_t load_stack[configMINIMAL_STACK_SIZE]; /* task stack */
+static ActiveQueueSlot load_queue[4];
+static Load load;
+
+/* the main function =======================================================*/
+int main() {
+
+    BSP_init(); /* initialize the BSP */
+
+    /* the Load preempts the Worker to post in the middle of its bulk work */
+    Worker_ctor(&worker);
+    Active_start(&worker.super,
+                 1U,
+                 worker_queue,
+                 sizeof(worker_queue)/sizeof(worker_queue[0]),
+                 worker_stack,
+                 sizeof(worker_stack),
+                 0U);
+
+    Load_ctor(&load);
+    Active_start(&load.super,
+                 2U,
+                 load_queue,
+                 sizeof(load_queue)/sizeof(load_queue[0]),
+                 load_stack,
+                 sizeof(load_stack),
+                 0U);
+
+    vTaskStartScheduler(); /* start the FreeRTOS scheduler... */
+    return 0; /* NOTE: the scheduler does NOT return */
+}
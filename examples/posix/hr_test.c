@@ -0,0 +1,222 @@
+/*****************************************************************************
+* Lab Project: HrTimeEvent test on the timerfd stand-in
+* Board: POSIX host (FreeRTOS POSIX port)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2005-2023 Quantum Leaps, LLC. All rights reserved.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+/* The HrTest AO checks, step by step (paced by a tick TimeEvent):
+* 1. one-shot HrTimeEvents armed out of order expire in deadline order,
+*    and one disarmed before its deadline never expires;
+* 2. a periodic HrTimeEvent keeps the deadlines on its grid (no drift)
+*    and posts at most once per expired period;
+* 3. after disarming it (and draining the posts already forwarded) the
+*    periodic HrTimeEvent expires no more.
+* The timerfd thread posts through an IsrChannel, which the tick hook of
+* bsp_posix.c forwards, so the expiries reach the AO up to a tick late.
+* NOTE: a host can run the timerfd thread late by more than a period, and
+* then the periods missed are skipped (by design, no bursts), so the test
+* reports such skips but does not count them as failures.
+*/
+#include "FreeAct.h" /* Free Active Object interface */
+#include "FreeAct_io.h" /* Free Active Object I/O services */
+#include "bsp.h"
+
+#include <stdio.h>
+
+#define ONE_SHOTS       3U
+#define PERIOD_US    2000U /* interval of the periodic HrTimeEvent */
+#define PERIODIC_MS   100U /* time the periodic HrTimeEvent runs */
+#define DRAIN_MS       10U /* time for the posts in flight to arrive */
+
+/* the deadlines of the one-shots, armed in this order [us] */
+static uint32_t const l_oneUs[ONE_SHOTS] = { 3000U, 1000U, 2000U };
+/* the expected order of the expiries (indexes into l_oneUs[]) */
+static uint8_t const l_oneOrder[ONE_SHOTS] = { 1U, 2U, 0U };
+
+enum Signals {
+    STEP_SIG = USER_SIG,   /* next step of the test (tick TimeEvent) */
+    ONE_SHOT_SIG,          /* a one-shot HrTimeEvent */
+    DISARMED_SIG,          /* the one-shot disarmed before expiring */
+    PERIODIC_SIG,          /* the periodic HrTimeEvent */
+};
+
+/* The HrTest AO ===========================================================*/
+typedef struct {
+    Active super;          /* inherit Active base class */
+    TimeEvent step;        /* paces the test steps */
+    HrTimeEvent one[ONE_SHOTS];
+    HrTimeEvent disarmed;
+    HrTimeEvent periodic;
+    uint8_t state;         /* current step */
+    uint8_t ones;          /* one-shot expiries so far */
+    uint8_t order[ONE_SHOTS]; /* the one-shots in the order of expiries */
+    uint32_t disarmedHits; /* expiries of the disarmed one-shot */
+    uint32_t periodicHits; /* expiries of the periodic HrTimeEvent */
+    uint32_t first;        /* first deadline of the periodic */
+    uint32_t due;          /* periods due until the disarm */
+    uint32_t drained;      /* periodic expiries after the drain */
+    uint8_t failed;        /* number of failed checks */
+} HrTest;
+
+enum HrTestSteps { STEP_ONE_SHOT, STEP_PERIODIC, STEP_DRAIN, STEP_QUIET };
+
+static void HrTest_check(HrTest * const me, BaseType_t ok,
+                         char const *what)
+{
+    printf("%-9s %s\n", (ok == pdTRUE) ? "ok" : "FAILED", what);
+    if (ok != pdTRUE) {
+        ++me->failed;
+    }
+}
+/*..........................................................................*/
+static void HrTest_dispatch(HrTest * const me, Event const * const e) {
+    switch (e->sig) {
+        case INIT_SIG: {
+            static IsrPost chanSto[16]; /* the posts of the timerfd thread */
+            BaseType_t const started = HrTimeEvent_hostStart(chanSto,
+                sizeof(chanSto)/sizeof(chanSto[0]));
+            uint8_t i;
+
+            FREEACT_ASSERT(started == pdTRUE);
+
+            for (i = 0U; i < ONE_SHOTS; ++i) {
+                HrTimeEvent_arm(&me->one[i], l_oneUs[i], 0U);
+            }
+            HrTimeEvent_arm(&me->disarmed, 1500U, 0U);
+            HrTimeEvent_disarm(&me->disarmed);
+
+            me->state = STEP_ONE_SHOT;
+            TimeEvent_arm(&me->step, 10U);
+            break;
+        }
+        case ONE_SHOT_SIG: {
+            if (me->ones < ONE_SHOTS) {
+                me->order[me->ones] =
+                    (uint8_t)((HrTimeEvent const *)e - &me->one[0]);
+            }
+            ++me->ones;
+            break;
+        }
+        case DISARMED_SIG: {
+            ++me->disarmedHits;
+            break;
+        }
+        case PERIODIC_SIG: {
+            ++me->periodicHits;
+            break;
+        }
+        case STEP_SIG: {
+            switch (me->state) {
+                case STEP_ONE_SHOT: {
+                    BaseType_t ok = (me->ones == ONE_SHOTS) ? pdTRUE : pdFALSE;
+                    uint8_t i;
+                    for (i = 0U; (ok == pdTRUE) && (i < ONE_SHOTS); ++i) {
+                        ok = (me->order[i] == l_oneOrder[i]) ? pdTRUE : pdFALSE;
+                    }
+                    HrTest_check(me, ok, "one-shots expire once, in deadline order");
+                    HrTest_check(me,
+                        (me->disarmedHits == 0U) ? pdTRUE : pdFALSE,
+                        "one-shot disarmed before its deadline never expires");
+
+                    HrTimeEvent_arm(&me->periodic, PERIOD_US, PERIOD_US);
+                    me->first = me->periodic.deadline;
+                    me->state = STEP_PERIODIC;
+                    TimeEvent_arm(&me->step, PERIODIC_MS);
+                    break;
+                }
+                case STEP_PERIODIC: {
+                    HrTimeEvent_disarm(&me->periodic);
+                    me->due = ((FreeAct_hrNow() - me->first) / PERIOD_US) + 1U;
+                    me->state = STEP_DRAIN;
+                    TimeEvent_arm(&me->step, DRAIN_MS);
+                    break;
+                }
+                case STEP_DRAIN: {
+                    /* the deadline after the disarm is the next one due */
+                    uint32_t const span = me->periodic.deadline - me->first;
+                    uint32_t const expired = span / PERIOD_US;
+
+                    printf("          periodic: %u posts, %u periods "
+                           "expired (%u skipped), %u due\n",
+                           (unsigned)me->periodicHits, (unsigned)expired,
+                           (unsigned)(expired - me->periodicHits),
+                           (unsigned)me->due);
+                    HrTest_check(me,
+                        (((span % PERIOD_US) == 0U) && (expired <= me->due)
+                         && (2U * expired >= me->due))
+                        ? pdTRUE : pdFALSE,
+                        "periodic deadlines stay on the grid (no drift)");
+                    HrTest_check(me,
+                        ((me->periodicHits <= expired)
+                         && (2U * me->periodicHits >= expired))
+                        ? pdTRUE : pdFALSE,
+                        "periodic posts at most once per period");
+                    me->drained = me->periodicHits;
+                    me->state = STEP_QUIET;
+                    TimeEvent_arm(&me->step, 2U * DRAIN_MS);
+                    break;
+                }
+                default: { /* STEP_QUIET */
+                    HrTest_check(me,
+                        ((me->periodicHits == me->drained)
+                         && (me->ones == ONE_SHOTS)
+                         && (me->disarmedHits == 0U))
+                        ? pdTRUE : pdFALSE,
+                        "no expiries after disarm");
+                    printf("%s\n", (me->failed == 0U) ? "PASS" : "FAIL");
+                    BSP_exit((me->failed == 0U) ? 0 : 1);
+                    break;
+                }
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+static void HrTest_ctor(HrTest * const me) {
+    uint8_t i;
+
+    Active_ctor(&me->super, (DispatchHandler)&HrTest_dispatch);
+    TimeEvent_ctor(&me->step, STEP_SIG, &me->super);
+    for (i = 0U; i < ONE_SHOTS; ++i) {
+        HrTimeEvent_ctor(&me->one[i], ONE_SHOT_SIG, &me->super);
+    }
+    HrTimeEvent_ctor(&me->disarmed, DISARMED_SIG, &me->super);
+    HrTimeEvent_ctor(&me->periodic, PERIODIC_SIG, &me->super);
+    me->ones         = 0U;
+    me->disarmedHits = 0U;
+    me->periodicHits = 0U;
+    me->failed       = 0U;
+}
+
+static StackType_t hrTest_stack[configMINIMAL_STACK_SIZE]; /* task stack */
+static ActiveQueueSlot hrTest_queue[32];
+static HrTest hrTest;
+
+/* the main function =======================================================*/
+int main() {
+
+    BSP_init(); /* initialize the BSP */
+
+    HrTest_ctor(&hrTest);
+    Active_start(&hrTest.super,
+                 1U,
+                 hrTest_queue,
+                 sizeof(hrTest_queue)/sizeof(hrTest_queue[0]),
+                 hrTest_stack,
+                 sizeof(hrTest_stack),
+                 0U);
+
+    vTaskStartScheduler(); /* start the FreeRTOS scheduler... */
+    return 0; /* NOTE: the scheduler does NOT return */
+}
@@ -39,27 +39,114 @@
 #include "queue.h"
 #include "timers.h"
 
+#include "FreeActConfig.h" /* application-specific FreeAct configuration */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Configuration defaults (override in FreeActConfig.h)... */
+
+/* assertion level: 0 - none, 1 - API and resource checks, 2 - all */
+#ifndef FREEACT_ASSERT_LEVEL
+#define FREEACT_ASSERT_LEVEL 2
+#endif
+
+/* AO event-queue backends */
+#define FREEACT_QUEUE_FREERTOS 0 /* FreeRTOS message queue */
+#define FREEACT_QUEUE_NOTIFY   1 /* ring buffer + direct-to-task notification */
+#define FREEACT_QUEUE_EDF      2 /* earliest-deadline-first heap + notification */
+
+#ifndef FREEACT_QUEUE
+#define FREEACT_QUEUE FREEACT_QUEUE_FREERTOS
+#endif
+
+/* tracing: 0 - none, 1 - call FreeAct_trace*() hooks (see below) */
+#ifndef FREEACT_TRACE
+#define FREEACT_TRACE 0
+#endif
+
+/* RTC-step budgets: 0 - none, N - measure every N-th RTC step (power of 2),
+* see Active_setBudget()
+*/
+#ifndef FREEACT_BUDGET
+#define FREEACT_BUDGET 0
+#endif
+
+/* critical-section profiler: 0 - none, 1 - measure the critical sections
+* (see FreeAct_csSite[])
+*/
+#ifndef FREEACT_CS_PROF
+#define FREEACT_CS_PROF 0
+#endif
+
+/* ISR-context detection: 1 - TimeEvent_arm()/_disarm() check at run time,
+* 0 - ISRs must call the explicit TimeEvent_armFromISR()/_disarmFromISR()
+*/
+#ifndef FREEACT_ISR_DETECT
+#define FREEACT_ISR_DETECT 1
+#endif
+
+/* maximum number of Active Objects */
+#ifndef FREEACT_MAX_ACTIVE
+#define FREEACT_MAX_ACTIVE 8U
+#endif
+
+/* size of event signal [bytes]: 1, 2, or 4 */
+#ifndef FREEACT_SIGNAL_SIZE
+#define FREEACT_SIGNAL_SIZE 2U
+#endif
+
+#if (FREEACT_MAX_ACTIVE < 1U) || (FREEACT_MAX_ACTIVE > 255U)
+#error "FREEACT_MAX_ACTIVE must be in range 1..255"
+#endif
+
+#if ((FREEACT_BUDGET & (FREEACT_BUDGET - 1)) != 0)
+#error "FREEACT_BUDGET must be 0 or a power of 2"
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Event facilities... */
 
+#if (FREEACT_SIGNAL_SIZE == 1U)
+typedef uint8_t Signal;  /* event signal */
+#elif (FREEACT_SIGNAL_SIZE == 2U)
 typedef uint16_t Signal; /* event signal */
+#elif (FREEACT_SIGNAL_SIZE == 4U)
+typedef uint32_t Signal; /* event signal */
+#else
+#error "FREEACT_SIGNAL_SIZE defined incorrectly, expected 1U, 2U, or 4U"
+#endif
 
 enum ReservedSignals {
     INIT_SIG, /* dispatched to AO before entering event-loop */
     USER_SIG  /* first signal available to the users */
 };
 
-typedef enum {
-    TYPE_ONE_SHOT = pdFALSE,    /* One-shot timer */
-    TYPE_PERIODIC = pdTRUE      /* Periodic timer */
-} TimerType_t;
-
 /* Event base class */
 typedef struct {
     Signal sig; /* event signal */
     /* event parameters added in subclasses of Event */
 } Event;
 
+/* high-resolution timestamp, see FreeAct_now() */
+typedef uint64_t FreeAct_Time;
+
+/* element of the AO's queue storage provided to Active_start() */
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+typedef struct {
+    FreeAct_Time deadline;      /* absolute deadline (FreeAct_now() units) */
+    Event const *e;             /* the event */
+    uint32_t seq;               /* post order, FIFO for equal deadlines */
+} ActiveQueueSlot;
+#else
+typedef Event *ActiveQueueSlot; /* (Event * for the existing storage) */
+#endif
+
+/* deadline of the events posted without one (after all deadlines) */
+#define FREEACT_NO_DEADLINE (~(FreeAct_Time)0)
+
 /*---------------------------------------------------------------------------*/
 /* Actvie Object facilities... */
 
@@ -68,52 +155,406 @@ typedef struct Active Active; /* forward declaration */
 typedef void (*DispatchHandler)(Active * const me, Event const * const e);
 
 /* Active Object base class */
+/* NOTE: FreeRTOS objects created with static allocation use the address
+* of the control block as the handle, so the handles are not stored.
+*/
 struct Active {
-    TaskHandle_t thread;     /* private thread */
-    StaticTask_t thread_cb;  /* thread control-block (FreeRTOS static alloc) */
+    StaticTask_t thread_cb;  /* private thread control-block (static alloc) */
 
-    QueueHandle_t queue;     /* private message queue */
-    StaticQueue_t queue_cb;  /* queue control-block (FreeRTOS static alloc) */
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+    StaticQueue_t queue_cb;  /* private queue control-block (static alloc) */
+#elif (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+    ActiveQueueSlot *queue;  /* private binary min-heap of events */
+    uint16_t queueLen;       /* capacity of the heap */
+    uint16_t queueUsed;      /* number of events in the heap */
+    uint32_t queueSeq;       /* sequence number of the next post */
+    FreeAct_Time deadline;   /* deadline of the event being processed */
+    uint32_t missed;         /* number of deadline misses */
+#else
+    Event const **queue;     /* private ring buffer of event pointers */
+    uint16_t queueLen;       /* length of the ring buffer */
+    uint16_t queueHead;      /* index for inserting events */
+    uint16_t queueTail;      /* index for extracting events */
+    uint16_t queueUsed;      /* number of events in the ring buffer */
+#endif
 
     DispatchHandler dispatch; /* pointer to the dispatch() function */
 
+#if (FREEACT_BUDGET != 0)
+    uint32_t budget;         /* RTC-step budget (FreeAct_now() units), 0-none */
+    uint32_t const *sigBudget; /* per-signal budgets (0 - use 'budget') */
+    Signal nSigBudget;       /* number of entries in sigBudget[] */
+    uint32_t steps;          /* RTC steps, for sampling the measurement */
+    uint32_t overruns;       /* measured RTC steps over the budget */
+    uint32_t maxStep;        /* longest measured RTC step */
+#endif
+
+#if (configUSE_TICKLESS_IDLE != 0)
+    uint32_t wakeups;        /* tickless sleeps ended by events for this AO */
+    uint32_t sleepTicks;     /* ticks slept before those wake-ups */
+#endif
+
     /* active object data added in subclasses of Active */
 };
 
+/* FreeRTOS handles of the AO's thread and queue */
+#define Active_thread(me_) ((TaskHandle_t)&(me_)->thread_cb)
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+#define Active_queue(me_)  ((QueueHandle_t)&(me_)->queue_cb)
+#endif
+
 void Active_ctor(Active * const me, DispatchHandler dispatch);
 void Active_start(Active * const me,
                   uint8_t prio,       /* priority (1-based) */
-                  Event **queueSto,
+                  ActiveQueueSlot *queueSto,
                   uint32_t queueLen,
                   void *stackSto,
                   uint32_t stackSize,
                   uint16_t opt);
+/* start the AO with a custom thread function 'loop' (e.g., a C++ event
+* loop with static dispatch), which receives the AO as its parameter
+* and should call Active_get() to wait for events
+*/
+void Active_startLoop(Active * const me,
+                      uint8_t prio,   /* priority (1-based) */
+                      ActiveQueueSlot *queueSto,
+                      uint32_t queueLen,
+                      void *stackSto,
+                      uint32_t stackSize,
+                      TaskFunction_t loop);
+Event const *Active_get(Active * const me); /* BLOCKING! */
+uint32_t Active_pending(Active * const me); /* events waiting in the queue */
+
 void Active_post(Active * const me, Event const * const e);
 void Active_postFromISR(Active * const me, Event const * const e,
                         BaseType_t *pxHigherPriorityTaskWoken);
 
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+/* post with an absolute deadline; the events are dispatched earliest-
+* deadline-first and an event dequeued or completed after its deadline
+* counts as a miss in me->missed
+*/
+void Active_postDeadline(Active * const me, Event const * const e,
+                         FreeAct_Time deadline);
+void Active_postDeadlineFromISR(Active * const me, Event const * const e,
+                                FreeAct_Time deadline,
+                                BaseType_t *pxHigherPriorityTaskWoken);
+
+/* count a miss if the RTC step of the event from the last Active_get()
+* completed after its deadline (for the custom event loops)
+*/
+void Active_deadlineEnd(Active * const me);
+#endif
+
+#if (FREEACT_BUDGET != 0)
+/* set the RTC-step budget of the AO and, optionally, per-signal budgets
+* (NULL for none); every FREEACT_BUDGET-th RTC step is measured with
+* FreeAct_now() around the dispatch, and an overrun calls
+* FreeAct_onOverrun() in the AO's thread, after the RTC step
+*/
+void Active_setBudget(Active * const me, uint32_t budget,
+                      uint32_t const *sigBudget, Signal nSigBudget);
+
+/* measure one RTC step (for the custom event loops) */
+void Active_stepEnd(Active * const me, Event const * const e,
+                    FreeAct_Time start);
+
+/* callback to be provided by the application */
+void FreeAct_onOverrun(Active * const me, Event const * const e,
+                       uint32_t elapsed);
+#endif
+
+#if (configUSE_TICKLESS_IDLE != 0)
+/* attribute the last tickless sleep to the AO, if no other AO claimed it
+* yet (for the custom event loops, called when an event was received)
+*/
+void Active_claimWakeup(Active * const me);
+#endif
+
+/* Active Objects started so far (in the order of Active_start() calls) */
+extern Active *FreeAct_active[FREEACT_MAX_ACTIVE];
+extern uint8_t FreeAct_activeCount;
+
 /*---------------------------------------------------------------------------*/
 /* Time Event facilities... */
 
-/* Time Event class */
+/* Time Event class
+* NOTE: the AO that requested the TimeEvent is kept as the timer ID
+*
+* The FreeRTOS timer is always one-shot. A periodic TimeEvent is re-armed
+* from the timer callback for the next deadline, computed from the previous
+* deadline (not from the time of the callback), so the period does not
+* drift. Periods in microseconds keep the fraction of a tick and spread it
+* over the expiries, so also these are exact on average.
+*
+* A TimeEvent armed with a slack may expire up to 'slack' ticks late. The
+* expiry is then rounded up to a multiple of the largest power of 2 not
+* exceeding slack+1, so the TimeEvents with overlapping tolerance windows
+* fall on the same tick. The timer daemon processes all the timers due on
+* a tick in one wake-up, so the CPU and the daemon wake up once for them.
+*/
 typedef struct {
     Event super;                /* inherit Event */
-    Active *act;                /* the AO that requested this TimeEvent */
-    TimerHandle_t timer;        /* private timer handle */
+    uint8_t volatile armed;     /* armed and not expired/disarmed yet */
+    TickType_t deadline;        /* tick of the next expiry */
+    TickType_t interval;        /* whole ticks of the period, 0 - one-shot */
+    uint32_t frac;              /* fraction of the period [1e-6 tick] */
+    uint32_t acc;               /* accumulated fraction [1e-6 tick] */
+    TickType_t slack;           /* tolerated lateness [ticks], 0 - exact */
     StaticTimer_t timer_cb;     /* timer control-block (FreeRTOS static alloc) */
-    TimerType_t type;           /* timer type, periodic or one-shot */
 } TimeEvent;
 
+/* FreeRTOS handle of the TimeEvent's timer */
+#define TimeEvent_timer(me_) ((TimerHandle_t)&(me_)->timer_cb)
+
+/* milliseconds in whole ticks (rounded down, but at least 1 tick) */
+TickType_t FreeAct_msToTicks(uint32_t millisec);
+
 void TimeEvent_ctor(TimeEvent * const me, Signal sig, Active *act);
-void TimeEvent_arm(TimeEvent * const me, uint32_t millisec);
+void TimeEvent_arm(TimeEvent * const me, uint32_t millisec); /* one-shot */
 void TimeEvent_disarm(TimeEvent * const me);
+void TimeEvent_armFromISR(TimeEvent * const me, uint32_t millisec,
+                          BaseType_t *pxHigherPriorityTaskWoken);
+void TimeEvent_disarmFromISR(TimeEvent * const me,
+                             BaseType_t *pxHigherPriorityTaskWoken);
+
+/* arm for the first expiry and then periodically (interval 0 - one-shot) */
+void TimeEvent_armX(TimeEvent * const me,
+                    TickType_t firstTicks, TickType_t intervalTicks);
+void TimeEvent_armXFromISR(TimeEvent * const me,
+                           TickType_t firstTicks, TickType_t intervalTicks,
+                           BaseType_t *pxHigherPriorityTaskWoken);
 
-/* static (i.e., class-wide) operation */
+/* the same in microseconds (the first expiry is rounded down to ticks) */
+void TimeEvent_armUs(TimeEvent * const me,
+                     uint32_t firstUs, uint32_t intervalUs);
+void TimeEvent_armUsFromISR(TimeEvent * const me,
+                            uint32_t firstUs, uint32_t intervalUs,
+                            BaseType_t *pxHigherPriorityTaskWoken);
+
+/* arm with a tolerated lateness (slack) for coalescing of the expiries */
+void TimeEvent_armSlack(TimeEvent * const me,
+                        uint32_t millisec, uint32_t slackMs);
+void TimeEvent_armSlackFromISR(TimeEvent * const me,
+                               uint32_t millisec, uint32_t slackMs,
+                               BaseType_t *pxHigherPriorityTaskWoken);
+void TimeEvent_armXSlack(TimeEvent * const me,
+                         TickType_t firstTicks, TickType_t intervalTicks,
+                         TickType_t slackTicks);
+void TimeEvent_armXSlackFromISR(TimeEvent * const me,
+                                TickType_t firstTicks,
+                                TickType_t intervalTicks,
+                                TickType_t slackTicks,
+                                BaseType_t *pxHigherPriorityTaskWoken);
+
+/* construct with a custom timer callback and timer ID (e.g., for the
+* TimeEvents of other AO classes); TimeEvent_ctor() uses the AO and the
+* callback posting to it
+*/
+void TimeEvent_init(TimeEvent * const me, Signal sig, void *timerId,
+                    TimerCallbackFunction_t callback);
+
+/* expiry of the timer (for the custom timer callbacks): re-arms a periodic
+* TimeEvent and returns pdTRUE if the event is to be posted
+*/
+BaseType_t TimeEvent_expire(TimeEvent * const me);
+
+/* static (i.e., class-wide) operation, to be called from the tick hook */
 void TimeEvent_tickFromISR(BaseType_t *pxHigherPriorityTaskWoken);
 
+/*---------------------------------------------------------------------------*/
+/* Timed post facilities...
+*
+* Active_postIn()/Active_postEvery() deliver any (immutable) event to an AO
+* after a delay, or periodically, without a dedicated TimeEvent. All timed
+* posts share one binary min-heap ordered by the due tick and checked in
+* TimeEvent_tickFromISR(), so they need no FreeRTOS timers and the memory
+* scales with the timed posts pending at the same time (the pool given to
+* FreeAct_timedInit()). The returned handle cancels the timed post.
+*/
+typedef struct {
+    Active *ao;                 /* the recipient AO */
+    Event const *e;             /* the event to post */
+    TickType_t due;             /* tick of the next post */
+    TickType_t interval;        /* period [ticks], 0 - one-shot */
+    uint16_t pos;               /* position in the heap */
+    uint16_t gen;               /* generation, to detect stale handles */
+} TimedPost;
+
+typedef uint32_t TimedHandle;   /* generation:16 | pool index:16, never 0 */
+
+void FreeAct_timedInit(TimedPost *sto,      /* pool of timed posts */
+                       uint16_t *heapSto,   /* heap of the same length */
+                       uint16_t len);
+
+TimedHandle Active_postIn(Active * const me, Event const * const e,
+                          uint32_t millisec);
+TimedHandle Active_postEvery(Active * const me, Event const * const e,
+                             uint32_t firstMs, uint32_t intervalMs);
+
+/* cancel the timed post, pdFALSE if it was delivered or cancelled already */
+BaseType_t Active_postCancel(TimedHandle h);
+
+/*---------------------------------------------------------------------------*/
+/* ISR context facilities...
+*
+* An ISR that performs several FreeACT operations can bracket them with
+* FreeAct_isrEnter()/FreeAct_isrExit() and pass &isr.xHigherPriorityTaskWoken
+* to the "FromISR" calls. TimeEvent_arm()/_disarm() called in the ISR then
+* accumulate into the same context instead of yielding by themselves, and
+* FreeAct_isrExit() requests the context switch exactly once. In nested
+* ISRs the inner context is merged into the outer one, so only the
+* outermost FreeAct_isrExit() yields.
+*/
+typedef struct FreeAct_Isr {
+    BaseType_t xHigherPriorityTaskWoken; /* accumulated over the ISR */
+    struct FreeAct_Isr *prev;   /* context of the preempted ISR, if any */
+} FreeAct_Isr;
+
+void FreeAct_isrEnter(FreeAct_Isr * const isr);
+void FreeAct_isrExit(FreeAct_Isr * const isr);
+
+/*---------------------------------------------------------------------------*/
+/* High-resolution time facilities... */
+
+/* monotonic 64-bit timestamp in units of FreeAct_timeFreq() [Hz]:
+ * CPU cycles on Cortex-M (DWT CYCCNT, or SysTick where there is no DWT),
+ * nanoseconds on a POSIX host.
+ */
+FreeAct_Time FreeAct_now(void); /* callable from any context */
+uint32_t FreeAct_timeFreq(void);
+
+/* microseconds in FreeAct_now() units (e.g., for the RTC-step budgets) */
+#define FREEACT_TIME_US(us_) \
+    ((uint32_t)(((uint64_t)(us_) * FreeAct_timeFreq()) / 1000000U))
+
+/*---------------------------------------------------------------------------*/
+/* Critical-section profiler facilities...
+*
+* The profiler measures the outermost critical sections (nested sections
+* count toward the outermost one) with FreeAct_now() and keeps the maximum
+* and a log2 histogram of the durations per call site, identified by the
+* return address of the outermost enter.
+*
+* The task-level sections of the kernel (tasks.c, queue.c, timers.c, ...)
+* and of FreeACT all call the port's vPortEnterCritical()/_ExitCritical(),
+* which FreeACT intercepts at link time: GNU ld needs
+* -Wl,--wrap=vPortEnterCritical,--wrap=vPortExitCritical, armlink patches
+* them with $Sub$$/$Super$$ by itself. The "FromISR" sections of FreeACT
+* and the application (the code that includes FreeAct.h) are measured
+* through taskENTER_CRITICAL_FROM_ISR()/taskEXIT_CRITICAL_FROM_ISR().
+* The kernel's own "FromISR" sections are inlined BASEPRI writes in the
+* port and are not measured.
+*/
+#if (FREEACT_CS_PROF != 0)
+
+#ifndef FREEACT_CS_SITES
+#define FREEACT_CS_SITES 32U /* call sites tracked */
+#endif
+#ifndef FREEACT_CS_BINS
+#define FREEACT_CS_BINS  16U /* histogram bins */
+#endif
+
+typedef struct {
+    void const *site;           /* return address of the outermost enter */
+    uint32_t count;             /* sections measured */
+    uint32_t max;               /* longest section [FreeAct_now() units] */
+    uint32_t hist[FREEACT_CS_BINS]; /* bin k: [2^k, 2^(k+1)) units */
+} FreeAct_CsSite;
+
+extern FreeAct_CsSite FreeAct_csSite[FREEACT_CS_SITES];
+extern uint32_t FreeAct_csMax;          /* longest section overall */
+extern void const *FreeAct_csMaxSite;   /* ... and its call site */
+extern uint32_t FreeAct_csLost;         /* sections of untracked sites */
+
+void FreeAct_csReset(void); /* task context */
+
+UBaseType_t FreeAct_csEnterFromISR(void);
+void FreeAct_csExitFromISR(UBaseType_t saved);
+
+#undef  taskENTER_CRITICAL_FROM_ISR
+#undef  taskEXIT_CRITICAL_FROM_ISR
+#define taskENTER_CRITICAL_FROM_ISR()   FreeAct_csEnterFromISR()
+#define taskEXIT_CRITICAL_FROM_ISR(x_)  FreeAct_csExitFromISR(x_)
+
+#endif /* FREEACT_CS_PROF */
+
+/*---------------------------------------------------------------------------*/
+/* Tickless idle facilities...
+*
+* TimeEvents are FreeRTOS timers, so the expected idle time computed by
+* the kernel already ends at the next TimeEvent expiry. FreeAct adds the
+* needs of the I/O (e.g., a Debouncer settling) through FreeAct_onSleep(),
+* keeps the high-resolution time base across the suppressed ticks, and
+* collects the sleep statistics. FreeRTOSConfig.h connects the hooks
+* (declared in the macros, because FreeRTOSConfig.h is included before
+* TickType_t is defined):
+*
+* #define configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING(x_) do { \
+*     extern TickType_t FreeAct_sleepBegin(TickType_t expectedIdle); \
+*     (x_) = FreeAct_sleepBegin(x_); \
+* } while (0)
+* #define traceLOW_POWER_IDLE_END() do { \
+*     extern void FreeAct_sleepEnd(void); \
+*     FreeAct_sleepEnd(); \
+* } while (0)
+*/
+#if (configUSE_TICKLESS_IDLE != 0)
+TickType_t FreeAct_sleepBegin(TickType_t expectedIdle); /* scheduler locked */
+void FreeAct_sleepEnd(void);                            /* scheduler locked */
+
+/* callback to be provided by the application: the ticks the I/O allows
+* to suppress out of 'expectedIdle' (0 - keep ticking). The callback also
+* arms the wake-up sources needed during the sleep (e.g., pin edges).
+*/
+TickType_t FreeAct_onSleep(TickType_t expectedIdle);
+
+extern uint32_t FreeAct_sleepCount; /* tickless sleeps entered */
+extern uint32_t FreeAct_sleepTicks; /* ticks spent in the tickless sleeps */
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Tracing facilities... */
+
+#if (FREEACT_TRACE != 0)
+/* callbacks to be provided by the application */
+void FreeAct_tracePost(Active const * const me, Event const * const e);
+void FreeAct_traceDispatch(Active const * const me, Event const * const e);
+
+#ifndef FREEACT_TRACE_POST
+#define FREEACT_TRACE_POST(me_, e_)     FreeAct_tracePost((me_), (e_))
+#endif
+#ifndef FREEACT_TRACE_DISPATCH
+#define FREEACT_TRACE_DISPATCH(me_, e_) FreeAct_traceDispatch((me_), (e_))
+#endif
+#endif /* FREEACT_TRACE */
+
+#ifndef FREEACT_TRACE_POST
+#define FREEACT_TRACE_POST(me_, e_)     ((void)0)
+#endif
+#ifndef FREEACT_TRACE_DISPATCH
+#define FREEACT_TRACE_DISPATCH(me_, e_) ((void)0)
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Assertion facilities... */
 
+/* FREEACT_ASSERT() checks API usage and resources (level >= 1),
+* FREEACT_ASSERT_DBG() checks internal invariants (level >= 2).
+* NOTE: the disabled checks are still compiled, so must have no side effects
+*/
+#if (FREEACT_ASSERT_LEVEL >= 1)
+#define FREEACT_ASSERT(check_)      configASSERT(check_)
+#else
+#define FREEACT_ASSERT(check_)      ((void)(check_))
+#endif
+
+#if (FREEACT_ASSERT_LEVEL >= 2)
+#define FREEACT_ASSERT_DBG(check_)  configASSERT(check_)
+#else
+#define FREEACT_ASSERT_DBG(check_)  ((void)(check_))
+#endif
+
 #define Q_ASSERT(check_)                   \
     if (!(check_)) {                       \
         Q_onAssert(this_module, __LINE__); \
@@ -121,4 +562,8 @@ void TimeEvent_tickFromISR(BaseType_t *pxHigherPriorityTaskWoken);
 
 void Q_onAssert(char const *module, int loc);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* FREE_ACT_H */
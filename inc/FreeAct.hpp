@@ -0,0 +1,634 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* C++17 interface (header-only, built on top of FreeAct.h)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_HPP
+#define FREE_ACT_HPP
+
+#include "FreeAct.h" /* Free Active Object C interface */
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/* maximum number of event pools (can be defined in FreeActConfig.h) */
+#ifndef FREEACT_MAX_POOLS
+#define FREEACT_MAX_POOLS 3U
+#endif
+
+namespace freeact {
+
+/*---------------------------------------------------------------------------*/
+/* Event facilities... */
+
+/* Event type with the signal assigned at compile time:
+*
+*     struct ButtonEvt : freeact::TypedEvent<BUTTON_SIG> {
+*         std::uint8_t id;
+*     };
+*/
+template<Signal SigValue>
+struct TypedEvent : public ::Event {
+    static constexpr Signal signal = SigValue;
+
+    constexpr TypedEvent() noexcept : ::Event{ SigValue } {}
+};
+
+/* checked downcast of the generic event to the TypedEvent subclass T */
+template<typename T>
+inline T const *event_cast(::Event const * const e) {
+    static_assert(std::is_base_of_v<::Event, T>, "T must derive from Event");
+    static_assert(std::is_same_v<decltype(T::signal), Signal const>,
+                  "T must derive from freeact::TypedEvent");
+    FREEACT_ASSERT_DBG(e->sig == T::signal);
+    return static_cast<T const *>(e);
+}
+
+/* Base of the fixed-block event pools, which provides the pool registry
+* and the reference counting of pool events.
+* NOTE: allocation, copying of EventPtr and garbage collection use
+* taskENTER_CRITICAL(), so they are allowed only in the task context.
+* Moving EventPtr (also into an AO queue) needs no critical section.
+* The pool events are recycled by the event loop of freeact::Active, so
+* they must not be posted to the plain C Active Objects.
+*/
+class EventPoolBase {
+public:
+    EventPoolBase(EventPoolBase const &) = delete;
+    EventPoolBase &operator=(EventPoolBase const &) = delete;
+
+    /* add a reference to the event, if it comes from a pool */
+    static void retain(::Event const * const e) {
+        EventPoolBase * const pool = lookup(e);
+        if (pool != nullptr) {
+            std::uint16_t const i = pool->index(e);
+            taskENTER_CRITICAL();
+            FREEACT_ASSERT(pool->m_refs[i] < 0xFFFFU); /* no wrap-around */
+            ++pool->m_refs[i];
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    /* drop a reference to the event and recycle it when none are left;
+    * called by the AO event loop after dispatching every event
+    */
+    static void gc(::Event const * const e) {
+        EventPoolBase * const pool = lookup(e);
+        if (pool != nullptr) {
+            std::uint16_t const i = pool->index(e);
+            taskENTER_CRITICAL();
+            FREEACT_ASSERT_DBG(pool->m_refs[i] > 0U);
+            --pool->m_refs[i];
+            if (pool->m_refs[i] == 0U) { /* last reference? */
+                FreeBlock * const blk = reinterpret_cast<FreeBlock *>(
+                    pool->m_begin + (i * pool->m_blockSize));
+                blk->next = pool->m_free;
+                pool->m_free = blk;
+                ++pool->m_nFree;
+            }
+            taskEXIT_CRITICAL();
+        }
+    }
+
+    std::uint16_t getNFree() const { return m_nFree; }
+
+protected:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    EventPoolBase(unsigned char * const sto, std::size_t const blockSize,
+                  std::uint16_t const nBlocks, std::uint16_t * const refs)
+      : m_begin(sto),
+        m_end(sto + (blockSize * nBlocks)),
+        m_blockSize(blockSize),
+        m_refs(refs),
+        m_free(nullptr),
+        m_nFree(nBlocks)
+    {
+        for (std::uint16_t i = nBlocks; i > 0U; --i) { /* build free list */
+            FreeBlock * const blk = reinterpret_cast<FreeBlock *>(
+                sto + ((i - 1U) * blockSize));
+            blk->next = m_free;
+            m_free = blk;
+            refs[i - 1U] = 0U;
+        }
+
+        FREEACT_ASSERT(s_nPools < FREEACT_MAX_POOLS); /* must fit */
+        s_pools[s_nPools] = this;
+        ++s_nPools;
+    }
+
+    /* allocate a block with one reference, nullptr if the pool is empty */
+    void *alloc() {
+        taskENTER_CRITICAL();
+        FreeBlock * const blk = m_free;
+        if (blk != nullptr) {
+            m_free = blk->next;
+            --m_nFree;
+            m_refs[index(blk)] = 1U;
+        }
+        taskEXIT_CRITICAL();
+        return blk;
+    }
+
+private:
+    static EventPoolBase *lookup(void const * const e) {
+        unsigned char const * const p = static_cast<unsigned char const *>(e);
+        for (std::uint8_t n = 0U; n < s_nPools; ++n) {
+            if ((p >= s_pools[n]->m_begin) && (p < s_pools[n]->m_end)) {
+                return s_pools[n];
+            }
+        }
+        return nullptr; /* not a pool event (e.g., a static event) */
+    }
+
+    std::uint16_t index(void const * const e) const {
+        return static_cast<std::uint16_t>(
+            (static_cast<unsigned char const *>(e) - m_begin) / m_blockSize);
+    }
+
+    unsigned char * const m_begin;
+    unsigned char const * const m_end;
+    std::size_t const m_blockSize;
+    std::uint16_t * const m_refs;  /* reference counters of the blocks */
+    FreeBlock *m_free;             /* head of the free list */
+    std::uint16_t m_nFree;         /* number of free blocks */
+
+    inline static EventPoolBase *s_pools[FREEACT_MAX_POOLS];
+    inline static std::uint8_t s_nPools;
+};
+
+/* Intrusive reference-counted handle to an event of type T. Copies add a
+* reference, moves hand off the ownership without touching the counter.
+*/
+template<typename T>
+class EventPtr {
+public:
+    constexpr EventPtr() noexcept : m_evt(nullptr) {}
+
+    /* take over one reference already owned by the caller */
+    static EventPtr adopt(T * const e) noexcept { return EventPtr(e); }
+
+    /* add a new reference to the event (e.g., kept beyond the RTC step) */
+    static EventPtr retain(T const * const e) {
+        EventPoolBase::retain(e);
+        return EventPtr(const_cast<T *>(e));
+    }
+
+    EventPtr(EventPtr &&other) noexcept : m_evt(other.m_evt) {
+        other.m_evt = nullptr;
+    }
+    EventPtr(EventPtr const &other) : m_evt(other.m_evt) {
+        if (m_evt != nullptr) {
+            EventPoolBase::retain(m_evt);
+        }
+    }
+    EventPtr &operator=(EventPtr &&other) noexcept {
+        if (this != &other) {
+            reset();
+            m_evt = other.m_evt;
+            other.m_evt = nullptr;
+        }
+        return *this;
+    }
+    EventPtr &operator=(EventPtr const &other) {
+        EventPtr(other).swap(*this);
+        return *this;
+    }
+    ~EventPtr() {
+        reset();
+    }
+
+    T *get() const noexcept { return m_evt; }
+    T *operator->() const noexcept { return m_evt; }
+    T &operator*() const noexcept { return *m_evt; }
+    explicit operator bool() const noexcept { return m_evt != nullptr; }
+
+    /* give up the ownership of the reference without releasing it */
+    T *release() noexcept {
+        T * const e = m_evt;
+        m_evt = nullptr;
+        return e;
+    }
+    void reset() {
+        if (m_evt != nullptr) {
+            EventPoolBase::gc(m_evt);
+            m_evt = nullptr;
+        }
+    }
+    void swap(EventPtr &other) noexcept {
+        T * const e = m_evt;
+        m_evt = other.m_evt;
+        other.m_evt = e;
+    }
+
+private:
+    explicit EventPtr(T * const e) noexcept : m_evt(e) {}
+
+    T *m_evt;
+};
+
+/* Fixed pool of N events of type T */
+template<typename T, std::uint16_t N>
+class EventPool : public EventPoolBase {
+    static_assert(std::is_base_of_v<::Event, T>, "T must derive from Event");
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "pool events are recycled without calling destructors");
+    static_assert(N > 0U, "event pool must not be empty");
+
+public:
+    EventPool() : EventPoolBase(m_sto[0].data, sizeof(Block), N, m_refs) {}
+
+    /* allocate and construct a new event (the pool must not be empty),
+    * an empty EventPtr when the pool is depleted and asserts are off
+    */
+    template<typename... Args>
+    EventPtr<T> make(Args &&... args) {
+        void * const mem = alloc();
+        FREEACT_ASSERT(mem != nullptr); /* event pool depleted */
+        if (mem == nullptr) {
+            return EventPtr<T>();
+        }
+        return EventPtr<T>::adopt(new (mem) T(std::forward<Args>(args)...));
+    }
+
+private:
+    struct alignas(alignof(T) > alignof(FreeBlock)
+                   ? alignof(T) : alignof(FreeBlock)) Block {
+        unsigned char data[sizeof(T) > sizeof(FreeBlock)
+                           ? sizeof(T) : sizeof(FreeBlock)];
+    };
+
+    Block m_sto[N];
+    std::uint16_t m_refs[N];
+};
+
+/*---------------------------------------------------------------------------*/
+/* Active Object template with static (CRTP) dispatch and its own storage.
+*
+* The Derived class provides a non-virtual dispatch() operation, which the
+* event loop calls directly, so the compiler can inline it:
+*
+*     class Blinky : public freeact::Active<Blinky, 10U, 1024U, 1U> {
+*     public:
+*         void dispatch(Event const * const e) {
+*             switch (e->sig) { ... }
+*         }
+*     };
+*
+*     static Blinky blinky;
+*     ...
+*     blinky.start();
+*/
+template<typename Derived,
+         std::uint16_t QueueLen,   /* length of the event queue */
+         std::size_t StackBytes,   /* size of the stack [bytes] */
+         std::uint8_t Prio>        /* priority (1-based) */
+class Active : public ::Active {
+    static_assert(QueueLen > 0U, "AO queue must not be empty");
+    static_assert((StackBytes % sizeof(StackType_t)) == 0U,
+                  "AO stack must be a whole number of StackType_t");
+    static_assert(StackBytes
+                  >= (configMINIMAL_STACK_SIZE * sizeof(StackType_t)),
+                  "AO stack smaller than configMINIMAL_STACK_SIZE");
+    static_assert((Prio >= 1U)
+                  && ((Prio + tskIDLE_PRIORITY) < configMAX_PRIORITIES),
+                  "AO priority out of range of configMAX_PRIORITIES");
+
+public:
+    static constexpr std::uint16_t queueLen = QueueLen;
+    static constexpr std::size_t stackBytes = StackBytes;
+    static constexpr std::uint8_t prio = Prio;
+
+    Active() {
+        /* the C dispatch handler is only for generic C code calling
+        * me->dispatch; the event loop below does not use it
+        */
+        Active_ctor(this, &Active::dispatchHandler);
+    }
+
+    Active(Active const &) = delete;
+    Active &operator=(Active const &) = delete;
+
+    void start() {
+        Active_startLoop(this, Prio,
+                         m_queueSto, QueueLen,
+                         m_stackSto, sizeof(m_stackSto),
+                         &Active::eventLoop);
+    }
+
+    void post(Event const * const e) {
+        Active_post(this, e);
+    }
+    void postFromISR(Event const * const e,
+                     BaseType_t *pxHigherPriorityTaskWoken)
+    {
+        Active_postFromISR(this, e, pxHigherPriorityTaskWoken);
+    }
+
+    /* post a pool event, handing off the caller's reference to the queue */
+    template<typename T>
+    void post(EventPtr<T> &&e) {
+        Active_post(this, e.release());
+    }
+    /* post a pool event, keeping the caller's reference */
+    template<typename T>
+    void post(EventPtr<T> const &e) {
+        EventPoolBase::retain(e.get());
+        Active_post(this, e.get());
+    }
+
+private:
+    /* thread function for this AO type (FreeRTOS task signature) */
+    static void eventLoop(void *pvParameters) {
+        Derived * const me =
+            static_cast<Derived *>(static_cast<::Active *>(pvParameters));
+        static Event const initEvt = { INIT_SIG };
+
+        /* initialize the AO */
+        me->dispatch(&initEvt);
+
+        for (;;) {   /* for-ever "superloop" */
+            Event const * const e = Active_get(me); /* BLOCKING! */
+            FREEACT_ASSERT_DBG(e != nullptr);
+
+#if (configUSE_TICKLESS_IDLE != 0)
+            Active_claimWakeup(me);
+#endif
+
+            FREEACT_TRACE_DISPATCH(me, e);
+
+#if (FREEACT_BUDGET != 0)
+            /* measure only every FREEACT_BUDGET-th RTC step */
+            bool const sample = ((++me->steps & (FREEACT_BUDGET - 1U)) == 0U);
+            FreeAct_Time const start = sample ? FreeAct_now() : 0U;
+#endif
+
+            me->dispatch(e); /* direct call, NO BLOCKING! */
+
+#if (FREEACT_BUDGET != 0)
+            if (sample) {
+                Active_stepEnd(me, e, start);
+            }
+#endif
+
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+            Active_deadlineEnd(me);
+#endif
+
+            EventPoolBase::gc(e); /* recycle the event if it was a pool event */
+        }
+    }
+
+    static void dispatchHandler(::Active * const me, Event const * const e) {
+        static_cast<Derived *>(me)->dispatch(e);
+    }
+
+    ActiveQueueSlot m_queueSto[QueueLen];
+    StackType_t m_stackSto[StackBytes / sizeof(StackType_t)];
+};
+
+/*---------------------------------------------------------------------------*/
+/* Table-driven state machine facilities... */
+
+/* signal-to-column map for contiguous signals First .. First+N-1 */
+template<Signal First, std::size_t N>
+struct DenseSignals {
+    static_assert(N > 0U, "no signals");
+
+    static constexpr std::size_t size = N;
+    static constexpr std::size_t NONE = N; /* signal not in the table */
+
+    static constexpr std::size_t index(Signal const sig) noexcept {
+        return ((sig >= First) && (static_cast<std::size_t>(sig - First) < N))
+               ? static_cast<std::size_t>(sig - First)
+               : NONE;
+    }
+};
+
+/* signal-to-column map for sparse signals, with a multiplicative perfect
+* hash found at compile time. The lookup costs one multiply, one shift and
+* two table reads regardless of the number of signals.
+*/
+template<Signal... Sigs>
+struct SparseSignals {
+    static constexpr std::size_t size = sizeof...(Sigs);
+    static constexpr std::size_t NONE = size; /* signal not in the table */
+    static_assert((size > 0U) && (size < 255U), "number of signals");
+
+    static constexpr Signal sigs[size] = { Sigs... };
+
+private:
+    struct Hash {
+        std::uint32_t mult;
+        std::uint8_t bits;
+        bool found;
+    };
+
+    static constexpr std::uint32_t slot(Signal const sig,
+                                        std::uint32_t const mult,
+                                        std::uint8_t const bits) noexcept
+    {
+        return (bits == 0U)
+               ? 0U
+               : ((static_cast<std::uint32_t>(sig) * mult) >> (32U - bits));
+    }
+
+    static constexpr Hash findHash() noexcept {
+        std::uint8_t bits = 0U;
+        while ((std::size_t(1U) << bits) < size) {
+            ++bits;
+        }
+        for (; bits <= 8U; ++bits) { /* table of up to 256 slots */
+            std::uint32_t mult = 2654435761U; /* Knuth's golden ratio */
+            for (std::uint32_t tries = 0U; tries < 512U; ++tries) {
+                bool used[256] = {};
+                bool ok = true;
+                for (std::size_t i = 0U; ok && (i < size); ++i) {
+                    std::uint32_t const s = slot(sigs[i], mult, bits);
+                    ok = !used[s];
+                    used[s] = true;
+                }
+                if (ok) {
+                    return Hash{ mult, bits, true };
+                }
+                mult += 2U * 0x9E3779B9U; /* next odd multiplier */
+            }
+        }
+        return Hash{ 0U, 0U, false };
+    }
+
+    static constexpr Hash hash = findHash();
+    static_assert(hash.found, "no perfect hash for the signals (duplicates?)");
+
+    struct Slots {
+        std::uint8_t col[std::size_t(1U) << hash.bits];
+    };
+
+    static constexpr Slots makeSlots() noexcept {
+        Slots t{};
+        for (auto &c : t.col) {
+            c = static_cast<std::uint8_t>(NONE);
+        }
+        for (std::size_t i = 0U; i < size; ++i) {
+            t.col[slot(sigs[i], hash.mult, hash.bits)]
+                = static_cast<std::uint8_t>(i);
+        }
+        return t;
+    }
+
+    static constexpr Slots slots = makeSlots();
+
+public:
+    static constexpr std::size_t index(Signal const sig) noexcept {
+        std::size_t const c = slots.col[slot(sig, hash.mult, hash.bits)];
+        return ((c != NONE) && (sigs[c] == sig)) ? c : NONE;
+    }
+};
+
+/* Flat state machine driven by a state x signal table built at compile
+* time. The table is a constexpr static member of the Derived class, so it
+* is placed in ROM, and it must define every cell exactly once (checked
+* at compile time). Signals not in the SigMap are ignored.
+*
+*     class Blinky : public freeact::Active<Blinky, 10U, 1024U, 1U>,
+*                    public freeact::Fsm<Blinky, 2U,
+*                               freeact::DenseSignals<TIMEOUT_SIG, 2U>>
+*     {
+*     public:
+*         enum : std::uint8_t { OFF, ON };
+*         static void ledOn(Blinky &me, Event const *e)  { ... }
+*         static void ledOff(Blinky &me, Event const *e) { ... }
+*
+*         static constexpr Table table = makeTable({
+*             { OFF, TIMEOUT_SIG, &ledOn,  ON  },
+*             { OFF, BUTTON_SIG,  IGNORED, OFF },
+*             { ON,  TIMEOUT_SIG, &ledOff, OFF },
+*             { ON,  BUTTON_SIG,  &ledOff, OFF },
+*         });
+*
+*         Blinky() : Fsm(OFF) {}
+*         void dispatch(Event const * const e) { Fsm::dispatch(e); }
+*     };
+*/
+template<typename Derived, std::size_t NStates, typename SigMap>
+class Fsm {
+    static_assert((NStates > 0U) && (NStates <= 255U), "number of states");
+
+public:
+    using StateId = std::uint8_t;
+    using Action = void (*)(Derived &me, ::Event const *e);
+
+    static constexpr Action IGNORED = nullptr; /* defined, but no action */
+
+    /* one row of the table specification */
+    struct Tran {
+        StateId state;   /* source state */
+        Signal sig;      /* triggering signal */
+        Action action;   /* action to execute (or IGNORED) */
+        StateId next;    /* target state (the source state for internal) */
+    };
+
+    struct Cell {
+        Action action;
+        StateId next;
+        bool defined;
+    };
+
+    struct Table {
+        Cell cell[NStates][SigMap::size];
+        bool valid;    /* no duplicate cells, all states and signals known */
+        bool complete; /* every cell defined */
+    };
+
+    template<std::size_t N>
+    static constexpr Table makeTable(Tran const (&spec)[N]) noexcept {
+        Table t{};
+        t.valid = true;
+        for (std::size_t i = 0U; i < N; ++i) {
+            std::size_t const col = SigMap::index(spec[i].sig);
+            if ((spec[i].state >= NStates) || (spec[i].next >= NStates)
+                || (col == SigMap::NONE)
+                || t.cell[spec[i].state][col].defined)
+            {
+                t.valid = false;
+            }
+            else {
+                t.cell[spec[i].state][col]
+                    = Cell{ spec[i].action, spec[i].next, true };
+            }
+        }
+        t.complete = true;
+        for (std::size_t s = 0U; s < NStates; ++s) {
+            for (std::size_t c = 0U; c < SigMap::size; ++c) {
+                if (!t.cell[s][c].defined) {
+                    t.complete = false;
+                }
+            }
+        }
+        return t;
+    }
+
+    StateId getState() const noexcept { return m_state; }
+
+protected:
+    explicit constexpr Fsm(StateId const initial) noexcept
+      : m_state(initial)
+    {}
+
+    void dispatch(::Event const * const e) {
+        static_assert(Derived::table.valid,
+            "FSM table has duplicate cells or unknown states/signals");
+        static_assert(Derived::table.complete,
+            "FSM table does not define every state x signal cell");
+
+        std::size_t const col = SigMap::index(e->sig);
+        if (col != SigMap::NONE) {
+            Cell const &c = Derived::table.cell[m_state][col];
+            if (c.action != nullptr) {
+                (*c.action)(static_cast<Derived &>(*this), e);
+            }
+            m_state = c.next;
+        }
+    }
+
+private:
+    StateId m_state; /* current state */
+};
+
+} /* namespace freeact */
+
+#endif /* FREE_ACT_HPP */
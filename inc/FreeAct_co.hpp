@@ -0,0 +1,453 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* C++20 stackless Active Objects (coroutines), header-only
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_CO_HPP
+#define FREE_ACT_CO_HPP
+
+#if (__cplusplus < 202002L) && !defined(__cpp_impl_coroutine)
+#error "FreeAct_co.hpp requires C++20 coroutines (e.g., -std=c++20)"
+#endif
+
+#include "FreeAct.hpp" /* Free Active Object C++ interface */
+
+#include <coroutine>
+
+namespace freeact {
+namespace co {
+
+/*
+* Stackless Active Objects run as coroutines resumed by a single
+* Dispatcher (an ordinary AO with its own thread). Instead of a stack, each
+* coroutine AO needs only its coroutine frame, which is allocated from the
+* Dispatcher's static arena, plus a small event ring:
+*
+*     static freeact::co::Dispatcher<16U, 1024U, 1U, 512U> disp;
+*
+*     class Blinky : public freeact::co::CoActive<4U> {
+*     public:
+*         Blinky() : CoActive(disp) {}
+*         freeact::co::Task run() {
+*             for (;;) {
+*                 BSP_ledOn();
+*                 Event const *e = co_await receive(200U); // event or timeout
+*                 if (e == nullptr) { ... } // timeout
+*                 ...
+*             }
+*         }
+*     };
+*
+*     disp.start();           // start the Dispatcher first
+*     blinky.start(blinky.run());
+*
+* An event received by co_await is valid until the next co_await.
+* NOTE: all coroutine AOs of one Dispatcher share its thread, so a coroutine
+* must not block (other than by co_await).
+*/
+
+class CoActiveBase; /* forward declaration */
+
+/*---------------------------------------------------------------------------*/
+/* Static arena for the coroutine frames. The frames are allocated once,
+* when the coroutine AOs are started, and never freed.
+*/
+class Arena {
+public:
+    Arena(unsigned char * const sto, std::size_t const size) noexcept
+      : m_next(sto),
+        m_end(sto + size)
+    {}
+
+    Arena(Arena const &) = delete;
+    Arena &operator=(Arena const &) = delete;
+
+    void *alloc(std::size_t const size) noexcept {
+        constexpr std::size_t align = alignof(std::max_align_t);
+        std::size_t const n = (size + (align - 1U)) & ~(align - 1U);
+        void *p = nullptr;
+        taskENTER_CRITICAL();
+        if (n <= static_cast<std::size_t>(m_end - m_next)) {
+            p = m_next;
+            m_next += n;
+        }
+        taskEXIT_CRITICAL();
+        FREEACT_ASSERT(p != nullptr); /* arena too small for the frame */
+        return p;
+    }
+
+    std::size_t getFree() const noexcept {
+        return static_cast<std::size_t>(m_end - m_next);
+    }
+
+private:
+    unsigned char *m_next;
+    unsigned char * const m_end;
+};
+
+/*---------------------------------------------------------------------------*/
+/* Dispatcher interface used by the coroutine AOs */
+class DispatcherBase {
+public:
+    ::Active *getActive() const noexcept { return m_ao; }
+    Arena &getArena() const noexcept { return *m_arena; }
+
+protected:
+    DispatcherBase(::Active * const ao, Arena * const arena) noexcept
+      : m_ao(ao),
+        m_arena(arena)
+    {}
+
+private:
+    ::Active * const m_ao;
+    Arena * const m_arena;
+};
+
+/*---------------------------------------------------------------------------*/
+/* return type of the coroutine AO bodies */
+class Task {
+public:
+    struct promise_type {
+        /* frames come from the Dispatcher's arena of the coroutine AO,
+        * which is the first parameter (or the object of a member function)
+        */
+        template<typename Me, typename... Args>
+        static void *operator new(std::size_t const size,
+                                  Me &me, Args &&...) noexcept;
+        static void operator delete(void *, std::size_t) noexcept {
+            /* frames are never freed (Active Objects run forever) */
+        }
+        static Task get_return_object_on_allocation_failure() noexcept {
+            return Task{};
+        }
+
+        Task get_return_object() noexcept {
+            return Task{
+                std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            FREEACT_ASSERT(false); /* exceptions are not supported */
+        }
+    };
+
+    constexpr Task() noexcept : m_handle(nullptr) {}
+    Task(Task &&other) noexcept : m_handle(other.m_handle) {
+        other.m_handle = nullptr;
+    }
+    Task(Task const &) = delete;
+    Task &operator=(Task const &) = delete;
+
+    std::coroutine_handle<> release() noexcept {
+        std::coroutine_handle<> const h = m_handle;
+        m_handle = nullptr;
+        return h;
+    }
+
+private:
+    explicit Task(std::coroutine_handle<> const h) noexcept : m_handle(h) {}
+
+    std::coroutine_handle<> m_handle;
+};
+
+/*---------------------------------------------------------------------------*/
+/* private signals of the Dispatcher */
+enum : Signal {
+    CO_WAKE_SIG = USER_SIG, /* events posted to a coroutine AO */
+    CO_TIMEOUT_SIG          /* timeout of a coroutine AO expired */
+};
+
+/* Coroutine AO base (without the event ring storage) */
+class CoActiveBase {
+public:
+    CoActiveBase(CoActiveBase const &) = delete;
+    CoActiveBase &operator=(CoActiveBase const &) = delete;
+
+    /* start the coroutine AO with its body (the Dispatcher runs it) */
+    void start(Task &&body) {
+        m_handle = body.release();
+        FREEACT_ASSERT(m_handle); /* coroutine frame must be allocated */
+        wake();
+    }
+
+    void post(::Event const * const e) {
+        taskENTER_CRITICAL();
+        bool const doWake = insert(e);
+        taskEXIT_CRITICAL();
+        if (doWake) {
+            Active_post(m_disp.getActive(), &m_wakeEvt.super);
+        }
+    }
+    void postFromISR(::Event const * const e,
+                     BaseType_t *pxHigherPriorityTaskWoken)
+    {
+        UBaseType_t const saved = taskENTER_CRITICAL_FROM_ISR();
+        bool const doWake = insert(e);
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+        if (doWake) {
+            Active_postFromISR(m_disp.getActive(), &m_wakeEvt.super,
+                               pxHigherPriorityTaskWoken);
+        }
+    }
+
+    Arena &arena() const noexcept { return m_disp.getArena(); }
+
+    /* dispatch an internal event of the Dispatcher to the coroutine AO */
+    static void dispatch(::Event const * const e) {
+        if (e->sig == CO_WAKE_SIG) {
+            reinterpret_cast<WakeEvt const *>(e)->owner->run();
+        }
+        else if (e->sig == CO_TIMEOUT_SIG) {
+            reinterpret_cast<TimeoutEvt const *>(e)->owner->onTimeout();
+        }
+        else {
+            /* INIT_SIG and foreign signals are ignored */
+        }
+    }
+
+protected:
+    CoActiveBase(DispatcherBase &disp,
+                 ::Event const ** const ringSto, std::uint16_t const ringLen)
+      : m_disp(disp),
+        m_ring(ringSto),
+        m_ringLen(ringLen),
+        m_head(0U),
+        m_tail(0U),
+        m_used(0U),
+        m_wakePending(false),
+        m_started(false),
+        m_waiting(false),
+        m_timed(false),
+        m_received(nullptr),
+        m_current(nullptr),
+        m_deadline(0U),
+        m_wakeEvt{ { CO_WAKE_SIG }, this },
+        m_tmoEvt{}
+    {
+        m_tmoEvt.owner = this;
+        TimeEvent_ctor(&m_tmoEvt.te, CO_TIMEOUT_SIG, disp.getActive());
+    }
+
+    /* awaitable for the next event; with a timeout [ms] the result is
+    * nullptr when the timeout expires before any event arrives
+    */
+    class Receive {
+    public:
+        Receive(CoActiveBase &me, std::uint32_t const millisec) noexcept
+          : m_me(me),
+            m_millisec(millisec)
+        {}
+        bool await_ready() noexcept {
+            return m_me.tryGet(); /* event already in the ring? */
+        }
+        void await_suspend(std::coroutine_handle<>) noexcept {
+            m_me.m_waiting = true;
+            if (m_millisec != 0U) {
+                m_me.m_timed = true;
+                m_me.m_deadline = xTaskGetTickCount()
+                                  + (m_millisec / portTICK_PERIOD_MS);
+                TimeEvent_arm(&m_me.m_tmoEvt.te, m_millisec);
+            }
+        }
+        ::Event const *await_resume() noexcept {
+            /* the previous event is done (valid only until next co_await) */
+            if (m_me.m_current != nullptr) {
+                EventPoolBase::gc(m_me.m_current);
+            }
+            m_me.m_current = m_me.m_received;
+            return m_me.m_current;
+        }
+    private:
+        CoActiveBase &m_me;
+        std::uint32_t const m_millisec;
+    };
+
+    Receive receive() noexcept { return Receive(*this, 0U); }
+    Receive receive(std::uint32_t const millisec) noexcept {
+        FREEACT_ASSERT(millisec != 0U);
+        return Receive(*this, millisec);
+    }
+
+private:
+    struct WakeEvt {
+        ::Event super;
+        CoActiveBase *owner;
+    };
+    struct TimeoutEvt {
+        TimeEvent te;
+        CoActiveBase *owner;
+    };
+
+    void wake() {
+        taskENTER_CRITICAL();
+        bool const doWake = !m_wakePending;
+        m_wakePending = true;
+        taskEXIT_CRITICAL();
+        if (doWake) {
+            Active_post(m_disp.getActive(), &m_wakeEvt.super);
+        }
+    }
+
+    /* insert event into the ring (in a critical section), returns true
+    * if the Dispatcher needs to be woken up
+    */
+    bool insert(::Event const * const e) {
+        FREEACT_ASSERT(m_used < m_ringLen); /* ring must not overflow */
+        m_ring[m_head] = e;
+        m_head = (m_head + 1U == m_ringLen) ? 0U : m_head + 1U;
+        ++m_used;
+        bool const doWake = !m_wakePending;
+        m_wakePending = true;
+        return doWake;
+    }
+
+    /* take the next event from the ring into m_received (if any) */
+    bool tryGet() {
+        taskENTER_CRITICAL();
+        bool const got = (m_used != 0U);
+        if (got) {
+            m_received = m_ring[m_tail];
+            m_tail = (m_tail + 1U == m_ringLen) ? 0U : m_tail + 1U;
+            --m_used;
+        }
+        taskEXIT_CRITICAL();
+        return got;
+    }
+
+    /* called by the Dispatcher when events were posted (or at start) */
+    void run() {
+        taskENTER_CRITICAL();
+        m_wakePending = false;
+        taskEXIT_CRITICAL();
+
+        if (!m_started) { /* first run? */
+            m_started = true;
+            m_handle.resume(); /* run until the first co_await */
+        }
+        while (m_waiting && !m_handle.done() && tryGet()) {
+            m_waiting = false;
+            if (m_timed) {
+                m_timed = false;
+                TimeEvent_disarm(&m_tmoEvt.te);
+            }
+            m_handle.resume(); /* run until the next co_await */
+        }
+    }
+
+    /* called by the Dispatcher when the TimeEvent expired */
+    void onTimeout() {
+        /* ignore stale timeouts (disarmed too late) of the earlier waits */
+        if (m_waiting && m_timed
+            && (static_cast<TickType_t>(xTaskGetTickCount() - m_deadline)
+                < (portMAX_DELAY / 2U)))
+        {
+            m_waiting = false;
+            m_timed = false;
+            m_received = nullptr;
+            m_handle.resume(); /* run until the next co_await */
+        }
+    }
+
+    DispatcherBase &m_disp;
+    std::coroutine_handle<> m_handle;
+    ::Event const ** const m_ring;
+    std::uint16_t const m_ringLen;
+    std::uint16_t m_head;
+    std::uint16_t m_tail;
+    std::uint16_t m_used;
+    bool m_wakePending;  /* wake event posted to the Dispatcher */
+    bool m_started;      /* the coroutine ran to its first co_await */
+    bool m_waiting;      /* suspended in co_await receive() */
+    bool m_timed;        /* the wait has a timeout */
+    ::Event const *m_received; /* event taken from the ring */
+    ::Event const *m_current;  /* event being handled by the coroutine */
+    TickType_t m_deadline;     /* tick count when the timeout expires */
+    WakeEvt m_wakeEvt;
+    TimeoutEvt m_tmoEvt;
+};
+
+/*..........................................................................*/
+template<typename Me, typename... Args>
+inline void *Task::promise_type::operator new(std::size_t const size,
+                                              Me &me, Args &&...) noexcept
+{
+    return static_cast<CoActiveBase &>(me).arena().alloc(size);
+}
+
+/* Coroutine AO with an event ring of QueueLen events */
+template<std::uint16_t QueueLen>
+class CoActive : public CoActiveBase {
+    static_assert(QueueLen > 0U, "coroutine AO ring must not be empty");
+
+protected:
+    explicit CoActive(DispatcherBase &disp)
+      : CoActiveBase(disp, m_ringSto, QueueLen)
+    {}
+
+private:
+    ::Event const *m_ringSto[QueueLen];
+};
+
+/*---------------------------------------------------------------------------*/
+/* Dispatcher AO that runs the coroutine AOs in its thread
+* (QueueLen must cover one wake event per coroutine AO plus timeouts)
+*/
+template<std::uint16_t QueueLen, std::size_t StackBytes, std::uint8_t Prio,
+         std::size_t ArenaBytes>
+class Dispatcher
+  : public freeact::Active<Dispatcher<QueueLen, StackBytes, Prio, ArenaBytes>,
+                           QueueLen, StackBytes, Prio>,
+    public DispatcherBase
+{
+    static_assert(ArenaBytes > 0U, "arena for coroutine frames");
+
+public:
+    Dispatcher() noexcept
+      : DispatcherBase(this, &m_arena),
+        m_arena(m_arenaSto, ArenaBytes)
+    {}
+
+    void dispatch(::Event const * const e) {
+        CoActiveBase::dispatch(e);
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char m_arenaSto[ArenaBytes];
+    Arena m_arena;
+};
+
+} /* namespace co */
+} /* namespace freeact */
+
+#endif /* FREE_ACT_CO_HPP */
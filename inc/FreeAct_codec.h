@@ -0,0 +1,125 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Compact binary event codecs
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_CODEC_H
+#define FREE_ACT_CODEC_H
+
+#include "FreeAct.h"  /* Free Active Object interface */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Event codec facilities...
+*
+* The events are described in a schema file, from which the codec
+* generator (FreeAct_codec_gen.h) produces the event structs and their
+* encode/decode functions. On the wire every value is a varint (7 bits
+* per byte, LSB first), signed values are zig-zag encoded, and DELTA
+* fields are encoded as the difference to the same field of the previous
+* event of the stream. The codecs work byte by byte (endianness-safe),
+* never allocate, and the worst-case size of each event is a compile-time
+* constant <Type>_WIRE_MAX.
+*
+* Schema file (e.g., "app_events.def", no include guard):
+*
+*     FREEACT_EVENT(SensorEvt, SENSOR_SIG)
+*         FREEACT_FIELD(SensorEvt, u8,  channel)
+*         FREEACT_DELTA(SensorEvt, s32, value)
+*         FREEACT_DELTA(SensorEvt, u32, stamp)
+*     FREEACT_EVENT_END(SensorEvt)
+*
+* Field types: u8, u16, u32, s8, s16, s32.
+*
+* Header (e.g., "app_events.h"):
+*
+*     #define FREEACT_SCHEMA      "app_events.def"
+*     #define FREEACT_SCHEMA_NAME AppEvents
+*     #include "FreeAct_codec_gen.h"
+*
+* Implementation (exactly one .c file):
+*
+*     #include "app_events.h"
+*     #define FREEACT_CODEC_IMPL
+*     #include "FreeAct_codec_gen.h"
+*
+* This generates, for every event type T:
+*     uint16_t T_encode(T const *e, T const *prev, uint8_t *buf, uint16_t len);
+*     uint16_t T_decode(uint8_t const *buf, uint16_t len, T const *prev, T *e);
+* and for the whole schema the signal-dispatched AppEvents_encode() and
+* AppEvents_decode() with the union AppEvents_Storage fitting any event.
+* The functions return the number of bytes produced/consumed, or 0 when
+* the buffer is too short or malformed. 'prev' can be NULL (deltas to 0).
+*/
+
+/* worst-case size of a 32-bit varint [bytes] */
+#define FREEACT_VARINT_MAX 5U
+
+/* C types of the schema field types */
+#define FREEACT_CTYPE_u8  uint8_t
+#define FREEACT_CTYPE_u16 uint16_t
+#define FREEACT_CTYPE_u32 uint32_t
+#define FREEACT_CTYPE_s8  int8_t
+#define FREEACT_CTYPE_s16 int16_t
+#define FREEACT_CTYPE_s32 int32_t
+
+/* field value to/from the varint value */
+#define FREEACT_ENC_u8(x_)  ((uint32_t)(x_))
+#define FREEACT_ENC_u16(x_) ((uint32_t)(x_))
+#define FREEACT_ENC_u32(x_) ((uint32_t)(x_))
+#define FREEACT_ENC_s8(x_)  FreeAct_zigzag((int32_t)(x_))
+#define FREEACT_ENC_s16(x_) FreeAct_zigzag((int32_t)(x_))
+#define FREEACT_ENC_s32(x_) FreeAct_zigzag((int32_t)(x_))
+#define FREEACT_DEC_u8(v_)  ((uint8_t)(v_))
+#define FREEACT_DEC_u16(v_) ((uint16_t)(v_))
+#define FREEACT_DEC_u32(v_) ((uint32_t)(v_))
+#define FREEACT_DEC_s8(v_)  ((int8_t)FreeAct_unzigzag(v_))
+#define FREEACT_DEC_s16(v_) ((int16_t)FreeAct_unzigzag(v_))
+#define FREEACT_DEC_s32(v_) ((int32_t)FreeAct_unzigzag(v_))
+
+/* the primitives return the advanced pointer, or NULL on a short buffer
+* (a NULL input pointer propagates, so the checks can be done at the end)
+*/
+uint8_t *FreeAct_putVarint(uint8_t *p, uint8_t const *end, uint32_t v);
+uint8_t const *FreeAct_getVarint(uint8_t const *p, uint8_t const *end,
+                                 uint32_t *v);
+uint32_t FreeAct_zigzag(int32_t x);
+int32_t FreeAct_unzigzag(uint32_t v);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREE_ACT_CODEC_H */
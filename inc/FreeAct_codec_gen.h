@@ -0,0 +1,219 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Event codec generator (included once per use, see FreeAct_codec.h)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+/* NOTE: no include guard, this file expands the FREEACT_SCHEMA file
+* (struct types and prototypes), or the codec functions when
+* FREEACT_CODEC_IMPL is defined.
+*/
+#include "FreeAct_codec.h"
+
+#ifndef FREEACT_SCHEMA
+#error "FREEACT_SCHEMA (the schema file name) must be defined"
+#endif
+#ifndef FREEACT_SCHEMA_NAME
+#error "FREEACT_SCHEMA_NAME (the prefix of the schema functions) must be defined"
+#endif
+
+#define FREEACT_CAT_(a_, b_) a_##b_
+#define FREEACT_CAT(a_, b_)  FREEACT_CAT_(a_, b_)
+
+#ifndef FREEACT_CODEC_IMPL
+/*---------------------------------------------------------------------------*/
+/* event structs */
+#define FREEACT_EVENT(T_, sig_)    typedef struct { Event super;
+#define FREEACT_FIELD(T_, ty_, f_) FREEACT_CTYPE_##ty_ f_;
+#define FREEACT_DELTA(T_, ty_, f_) FREEACT_CTYPE_##ty_ f_;
+#define FREEACT_EVENT_END(T_)      } T_;
+#include FREEACT_SCHEMA
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+
+/* worst-case wire sizes (signal + fields) */
+#define FREEACT_EVENT(T_, sig_)    enum { T_##_WIRE_MAX = FREEACT_VARINT_MAX
+#define FREEACT_FIELD(T_, ty_, f_) + FREEACT_VARINT_MAX
+#define FREEACT_DELTA(T_, ty_, f_) + FREEACT_VARINT_MAX
+#define FREEACT_EVENT_END(T_)      };
+#include FREEACT_SCHEMA
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+
+/* storage fitting any event of the schema */
+#define FREEACT_EVENT(T_, sig_)    T_ T_##_m;
+#define FREEACT_FIELD(T_, ty_, f_)
+#define FREEACT_DELTA(T_, ty_, f_)
+#define FREEACT_EVENT_END(T_)
+typedef union {
+    Event super;
+#include FREEACT_SCHEMA
+} FREEACT_CAT(FREEACT_SCHEMA_NAME, _Storage);
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+
+/* prototypes */
+#define FREEACT_EVENT(T_, sig_) \
+    uint16_t T_##_encode(T_ const * const e, T_ const * const prev, \
+                         uint8_t *buf, uint16_t len); \
+    uint16_t T_##_decode(uint8_t const *buf, uint16_t len, \
+                         T_ const * const prev, T_ * const e);
+#define FREEACT_FIELD(T_, ty_, f_)
+#define FREEACT_DELTA(T_, ty_, f_)
+#define FREEACT_EVENT_END(T_)
+#include FREEACT_SCHEMA
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+
+uint16_t FREEACT_CAT(FREEACT_SCHEMA_NAME, _encode)(Event const * const e,
+    Event const * const prev, uint8_t *buf, uint16_t len);
+uint16_t FREEACT_CAT(FREEACT_SCHEMA_NAME, _decode)(uint8_t const *buf,
+    uint16_t len, Event const * const prev,
+    FREEACT_CAT(FREEACT_SCHEMA_NAME, _Storage) * const e);
+
+#else /* FREEACT_CODEC_IMPL */
+/*---------------------------------------------------------------------------*/
+/* encoders */
+#define FREEACT_EVENT(T_, sig_) \
+uint16_t T_##_encode(T_ const * const e, T_ const * const prev, \
+                     uint8_t *buf, uint16_t len) \
+{ \
+    uint8_t *p = buf; \
+    uint8_t const * const end = &buf[len]; \
+    (void)prev; \
+    p = FreeAct_putVarint(p, end, (uint32_t)e->super.sig);
+#define FREEACT_FIELD(T_, ty_, f_) \
+    p = FreeAct_putVarint(p, end, FREEACT_ENC_##ty_(e->f_));
+#define FREEACT_DELTA(T_, ty_, f_) \
+    p = FreeAct_putVarint(p, end, FreeAct_zigzag((int32_t)( \
+            (uint32_t)e->f_ \
+            - (uint32_t)((prev != (T_ const *)0) ? prev->f_ : 0))));
+#define FREEACT_EVENT_END(T_) \
+    return (p != (uint8_t *)0) ? (uint16_t)(p - buf) : 0U; \
+}
+#include FREEACT_SCHEMA
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+
+/* decoders */
+#define FREEACT_EVENT(T_, sig_) \
+uint16_t T_##_decode(uint8_t const *buf, uint16_t len, \
+                     T_ const * const prev, T_ * const e) \
+{ \
+    uint8_t const *p = buf; \
+    uint8_t const * const end = &buf[len]; \
+    uint32_t v; \
+    (void)prev; \
+    p = FreeAct_getVarint(p, end, &v); \
+    if (v != (uint32_t)(sig_)) { \
+        return 0U; \
+    } \
+    e->super.sig = (Signal)v;
+#define FREEACT_FIELD(T_, ty_, f_) \
+    p = FreeAct_getVarint(p, end, &v); \
+    e->f_ = FREEACT_DEC_##ty_(v);
+#define FREEACT_DELTA(T_, ty_, f_) \
+    p = FreeAct_getVarint(p, end, &v); \
+    e->f_ = (FREEACT_CTYPE_##ty_)( \
+            (uint32_t)((prev != (T_ const *)0) ? prev->f_ : 0) \
+            + (uint32_t)FreeAct_unzigzag(v));
+#define FREEACT_EVENT_END(T_) \
+    return (p != (uint8_t const *)0) ? (uint16_t)(p - buf) : 0U; \
+}
+#include FREEACT_SCHEMA
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+
+/* signal-dispatched encoder of the schema */
+uint16_t FREEACT_CAT(FREEACT_SCHEMA_NAME, _encode)(Event const * const e,
+    Event const * const prev, uint8_t *buf, uint16_t len)
+{
+    switch (e->sig) {
+#define FREEACT_EVENT(T_, sig_) \
+        case (sig_): { \
+            return T_##_encode((T_ const *)e, (T_ const *)prev, buf, len); \
+        }
+#define FREEACT_FIELD(T_, ty_, f_)
+#define FREEACT_DELTA(T_, ty_, f_)
+#define FREEACT_EVENT_END(T_)
+#include FREEACT_SCHEMA
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+        default: {
+            return 0U; /* not in the schema */
+        }
+    }
+}
+
+/* signal-dispatched decoder of the schema ('prev' of the same signal) */
+uint16_t FREEACT_CAT(FREEACT_SCHEMA_NAME, _decode)(uint8_t const *buf,
+    uint16_t len, Event const * const prev,
+    FREEACT_CAT(FREEACT_SCHEMA_NAME, _Storage) * const e)
+{
+    uint32_t sig;
+
+    if (FreeAct_getVarint(buf, &buf[len], &sig) == (uint8_t const *)0) {
+        return 0U;
+    }
+    switch (sig) {
+#define FREEACT_EVENT(T_, sig_) \
+        case (sig_): { \
+            return T_##_decode(buf, len, (T_ const *)prev, &e->T_##_m); \
+        }
+#define FREEACT_FIELD(T_, ty_, f_)
+#define FREEACT_DELTA(T_, ty_, f_)
+#define FREEACT_EVENT_END(T_)
+#include FREEACT_SCHEMA
+#undef FREEACT_EVENT
+#undef FREEACT_FIELD
+#undef FREEACT_DELTA
+#undef FREEACT_EVENT_END
+        default: {
+            return 0U; /* not in the schema */
+        }
+    }
+}
+
+#endif /* FREEACT_CODEC_IMPL */
@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Lightweight (stackless) Active Objects on FreeRTOS co-routines
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_CR_H
+#define FREE_ACT_CR_H
+
+#include "FreeAct.h"  /* Free Active Object interface */
+#include "croutine.h"
+
+/* Lightweight Active Objects run their event loops as FreeRTOS co-routines,
+* so they need neither a stack nor a task control block. All co-routines
+* share the stack of the task calling FreeAct_crSchedule() (e.g., the idle
+* task from vApplicationIdleHook()) or of the dedicated co-routine task
+* started with FreeAct_crStartTask().
+*
+* NOTE: the application must set configUSE_CO_ROUTINES to 1. FreeRTOS
+* allocates the co-routine control blocks with pvPortMalloc(), so a heap
+* of (number of ActiveCR) * sizeof(CRCB_t) bytes is needed as well.
+* The dispatch handlers must not block and are subject to all co-routine
+* restrictions (no blocking FreeRTOS calls).
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* maximum number of lightweight Active Objects */
+#ifndef FREEACT_MAX_ACTIVE_CR
+#define FREEACT_MAX_ACTIVE_CR 8U
+#endif
+
+typedef struct ActiveCR ActiveCR; /* forward declaration */
+
+typedef void (*DispatchHandlerCR)(ActiveCR * const me, Event const * const e);
+
+/* lightweight Active Object base class */
+struct ActiveCR {
+    StaticQueue_t queue_cb;     /* private co-routine queue control-block */
+    Event const *evt;           /* current event (co-routine locals are lost) */
+    DispatchHandlerCR dispatch; /* pointer to the dispatch() function */
+
+    /* active object data added in subclasses of ActiveCR */
+};
+
+/* FreeRTOS handle of the ActiveCR's queue */
+#define ActiveCR_queue(me_) ((QueueHandle_t)&(me_)->queue_cb)
+
+void ActiveCR_ctor(ActiveCR * const me, DispatchHandlerCR dispatch);
+void ActiveCR_start(ActiveCR * const me,
+                    uint8_t prio,       /* co-routine priority (0-based) */
+                    Event **queueSto,
+                    uint32_t queueLen);
+void ActiveCR_post(ActiveCR * const me, Event const * const e);
+void ActiveCR_postFromISR(ActiveCR * const me, Event const * const e,
+                          BaseType_t *pxHigherPriorityTaskWoken);
+
+/* TimeEvent posting to a lightweight Active Object
+* (arm/disarm with the regular TimeEvent_arm()/TimeEvent_disarm())
+*/
+void TimeEvent_ctorCR(TimeEvent * const me, Signal sig, ActiveCR *act);
+
+/* run the ready co-routines, e.g., from vApplicationIdleHook() */
+void FreeAct_crSchedule(void);
+
+/* alternatively, run the co-routines in a dedicated task */
+void FreeAct_crStartTask(uint8_t prio, /* priority (1-based) */
+                         void *stackSto,
+                         uint32_t stackSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREE_ACT_CR_H */
@@ -0,0 +1,282 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* I/O services for Active Objects
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_IO_H
+#define FREE_ACT_IO_H
+
+#include "FreeAct.h"  /* Free Active Object interface */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Debouncer service...
+*
+* Debouncer debounces whole 32-bit input words (e.g., GPIO port registers)
+* bit-parallel, so the work per tick depends only on the number of words
+* and not on the number of inputs or on how many of them change. An input
+* changes its debounced state after it was sampled the same in 'samples'
+* consecutive ticks (2 samples is the classic Ganssle/Barr algorithm).
+*
+* The Debouncer itself is the change-set event posted to the AO, at most
+* once per tick and only when no change-set is pending already. The AO
+* then calls Debouncer_read() to collect the inputs changed since the
+* previous read and the current debounced state.
+*
+* Between the input changes the Debouncer needs no ticks. For the tickless
+* idle, FreeAct_onSleep() checks Debouncer_isSettled() and arms the pin-edge
+* interrupts, whose ISR calls Debouncer_edgeFromISR() to resume sampling.
+*/
+
+/* number of uint32_t words of storage for a Debouncer */
+#define DEBOUNCER_STO_SIZE(nPorts_, samples_) ((nPorts_) * ((samples_) + 1U))
+
+typedef struct {
+    Event super;                /* inherit Event (the change-set event) */
+    Active *ao;                 /* the AO receiving the change-set events */
+    uint32_t *history;          /* (samples - 1) past samples per word */
+    uint32_t *stable;           /* debounced state per word */
+    uint32_t *changed;          /* changes since the last read per word */
+    uint8_t nPorts;             /* number of input words */
+    uint8_t samples;            /* number of equal samples for a change */
+    uint8_t idx;                /* index of the oldest sample in history */
+    uint8_t volatile pending;   /* change-set event posted and not read */
+    uint8_t volatile edge;      /* input edge seen, not sampled yet */
+} Debouncer;
+
+void Debouncer_ctor(Debouncer * const me, Signal sig, Active *ao,
+                    uint32_t *sto,   /* DEBOUNCER_STO_SIZE() words */
+                    uint8_t nPorts,
+                    uint8_t samples);
+
+/* process one sample of all input words (bit==1 means active) */
+void Debouncer_tickFromISR(Debouncer * const me, uint32_t const *ports,
+                           BaseType_t *pxHigherPriorityTaskWoken);
+
+/* collect the change-set event 'e' (called by the AO, task context) */
+void Debouncer_read(Event const * const e,
+                    uint32_t *changed, uint32_t *state);
+
+/* pdTRUE when all samples equal the debounced state (task context) */
+BaseType_t Debouncer_isSettled(Debouncer * const me);
+
+/* an input edge woke up the system, keep sampling (pin-edge ISR) */
+void Debouncer_edgeFromISR(Debouncer * const me);
+
+/*---------------------------------------------------------------------------*/
+/* Zero-latency ISR channel facilities...
+*
+* ISRs prioritized above configMAX_SYSCALL_INTERRUPT_PRIORITY must not
+* call any FreeRTOS API, so they post to AOs through an IsrChannel: a
+* single-producer/single-consumer ring (one channel per such ISR), written
+* without masking interrupts. Every post pends the forwarding software
+* interrupt (at a kernel-aware priority), whose handler must call
+* IsrChannel_forwardFromISR() to post the events to the AOs.
+*
+* The forwarding interrupt is selected in FreeActConfig.h either by its
+* IRQ number FREEACT_SWI_IRQ (Cortex-M NVIC) or by a custom pend macro
+* FREEACT_SWI_PEND(). Without either, IsrChannel_forwardFromISR() must be
+* called periodically (e.g., from the tick hook).
+*
+* On a POSIX host the producers are native threads (e.g., ShmLink or the
+* HrTimeEvent stand-in) running on other cores, so the ring indexes are
+* published with acquire/release atomics. There is no software interrupt:
+* the application calls IsrChannel_forwardFromISR() from
+* vApplicationTickHook(), which the FreeRTOS POSIX port runs in the
+* kernel-aware tick context.
+*/
+#ifndef FREEACT_SWI_PEND
+#ifdef FREEACT_SWI_IRQ
+/* NVIC_ISPR: set-pending is a single store, safe at any priority */
+#define FREEACT_SWI_PEND() \
+    ((*(uint32_t volatile *)(0xE000E200U + (((FREEACT_SWI_IRQ) >> 5) << 2))) \
+        = (1UL << ((FREEACT_SWI_IRQ) & 0x1FU)))
+#else
+#define FREEACT_SWI_PEND() ((void)0)
+#endif
+#endif
+
+/* event posted through an IsrChannel */
+typedef struct {
+    Active *ao;                 /* the recipient AO */
+    Event const *e;             /* the event */
+} IsrPost;
+
+typedef struct IsrChannel {
+    IsrPost *buf;               /* ring buffer of posts */
+    uint16_t len;               /* number of slots in the ring */
+    uint16_t volatile head;     /* written only by the producer ISR */
+    uint16_t volatile tail;     /* written only by the forwarder */
+    uint16_t volatile lost;     /* posts lost on full ring (producer) */
+    struct IsrChannel *next;    /* next registered channel */
+} IsrChannel;
+
+/* register the channel (task context, before enabling the producer ISR) */
+void IsrChannel_ctor(IsrChannel * const me, IsrPost *bufSto, uint16_t len);
+
+/* post from the high-priority producer ISR; returns pdFALSE if full */
+BaseType_t IsrChannel_post(IsrChannel * const me, Active *ao,
+                           Event const * const e);
+
+/* static (i.e., class-wide) operation, to be called from the forwarding
+* software interrupt (kernel-aware priority)
+*/
+void IsrChannel_forwardFromISR(BaseType_t *pxHigherPriorityTaskWoken);
+
+/*---------------------------------------------------------------------------*/
+/* Coalescing channel facilities...
+*
+* Coalescer batches samples appended by an ISR into blocks, so that one
+* event is posted per block instead of one per sample. The ISR fills one
+* half of a double buffer; the block is handed over to the AO when the
+* count threshold is reached or when the timeout (a TimeEvent armed at
+* the first sample of the block) expires, whichever comes first. Both the
+* threshold and the timeout can be changed at run time, to trade latency
+* for throughput per stream.
+*
+* The block-ready event (the Coalescer itself) and the timeout TimeEvent
+* have the same signal. For either of them the AO calls Coalescer_take()
+* to get the block (empty for a stale timeout) and, for a non-empty block,
+* Coalescer_release() when done with it. Until the release, the ISR keeps
+* filling the other half up to its capacity and counts the samples that
+* do not fit as lost.
+*/
+typedef struct {
+    Event super;                /* inherit Event (the block-ready event) */
+    TimeEvent timeout;          /* flush timeout (the same signal) */
+    Active *ao;                 /* the AO receiving the blocks */
+    uint32_t *block[2];         /* the double buffer */
+    uint16_t volatile count[2]; /* number of samples in each block */
+    TickType_t start[2];        /* tick of the first sample in each block */
+    uint16_t cap;               /* capacity of each block */
+    uint16_t volatile threshold;/* block size that triggers the post */
+    uint32_t volatile timeoutMs;/* block timeout [ms] (0 - no timeout) */
+    uint8_t volatile fill;      /* index of the block filled by the ISR */
+    uint8_t volatile busy;      /* the other block is held by the AO */
+    uint16_t volatile lost;     /* samples lost on full block */
+} Coalescer;
+
+void Coalescer_ctor(Coalescer * const me, Signal sig, Active *ao,
+                    uint32_t *sto,  /* storage for 2*cap samples */
+                    uint16_t cap,
+                    uint16_t threshold,
+                    uint32_t timeoutMs);
+void Coalescer_setThreshold(Coalescer * const me, uint16_t threshold);
+void Coalescer_setTimeout(Coalescer * const me, uint32_t timeoutMs);
+
+/* append a sample from the (single) producer ISR */
+void Coalescer_appendFromISR(Coalescer * const me, uint32_t sample,
+                             BaseType_t *pxHigherPriorityTaskWoken);
+
+/* called by the AO (task context) for the event 'e' of the Coalescer */
+uint16_t Coalescer_take(Coalescer * const me, Event const * const e,
+                        uint32_t const **samples);
+void Coalescer_release(Coalescer * const me);
+
+/*---------------------------------------------------------------------------*/
+/* High-resolution Time Event facilities...
+*
+* HrTimeEvent expires with the resolution of a free-running 32-bit hardware
+* counter instead of the FreeRTOS tick, so the sub-millisecond timeouts do
+* not need a faster tick. The armed HrTimeEvents are kept sorted by their
+* deadlines and only the nearest deadline is programmed into the compare
+* channel of the counter. The compare ISR (kernel-aware priority) calls
+* HrTimeEvent_compareFromISR(), which posts the expired HrTimeEvents and
+* programs the next deadline. Periodic HrTimeEvents are re-armed from the
+* previous deadline, with the fraction of a count spread over the periods.
+*
+* The board provides the counter through the FreeAct_hr*() callbacks. The
+* longest delay is 2^31 counts (e.g., 10.7s at 200MHz). On a Linux host,
+* FreeAct_io.c provides the callbacks itself: CLOCK_MONOTONIC in
+* microseconds and a timerfd serviced by a thread, which posts through an
+* IsrChannel (started by HrTimeEvent_hostStart()).
+*
+* NOTE: disarming cannot recall an HrTimeEvent already posted to the AO.
+*/
+#ifndef FREEACT_HR_TIMER
+#define FREEACT_HR_TIMER 0
+#endif
+
+#if (FREEACT_HR_TIMER != 0)
+
+typedef struct HrTimeEvent {
+    Event super;                /* inherit Event */
+    Active *ao;                 /* the AO receiving the HrTimeEvent */
+    struct HrTimeEvent *next;   /* next armed, in the order of deadlines */
+    uint32_t deadline;          /* counter value of the next expiry */
+    uint32_t interval;          /* whole counts of the period, 0 - one-shot */
+    uint32_t frac;              /* fraction of the period [1e-6 count] */
+    uint32_t acc;               /* accumulated fraction [1e-6 count] */
+    uint8_t volatile armed;     /* armed and not expired/disarmed yet */
+} HrTimeEvent;
+
+void HrTimeEvent_ctor(HrTimeEvent * const me, Signal sig, Active *ao);
+
+/* arm for the first expiry and then periodically (interval 0 - one-shot) */
+void HrTimeEvent_arm(HrTimeEvent * const me,
+                     uint32_t firstUs, uint32_t intervalUs);
+void HrTimeEvent_disarm(HrTimeEvent * const me);
+void HrTimeEvent_armFromISR(HrTimeEvent * const me,
+                            uint32_t firstUs, uint32_t intervalUs);
+void HrTimeEvent_disarmFromISR(HrTimeEvent * const me);
+
+/* static (i.e., class-wide) operation, to be called from the compare ISR */
+void HrTimeEvent_compareFromISR(BaseType_t *pxHigherPriorityTaskWoken);
+
+/* callbacks to be provided by the board (kernel-aware contexts only) */
+uint32_t FreeAct_hrNow(void);   /* free-running 32-bit counter */
+uint32_t FreeAct_hrFreq(void);  /* counter frequency [Hz] */
+
+/* interrupt when the counter reaches 'at'. If 'at' is not in the future
+* anymore, the callback must pend the compare interrupt right away.
+*/
+void FreeAct_hrSetCompare(uint32_t at);
+void FreeAct_hrStop(void);      /* no deadline: no compare interrupts */
+
+#if defined(__unix__) || defined(__APPLE__) /* POSIX host? */
+/* start the timerfd stand-in (task context, before arming), the posts
+* are forwarded by IsrChannel_forwardFromISR() (e.g., in the tick hook).
+* NOTE: the stand-in needs Linux, other POSIX hosts fail to compile it.
+*/
+BaseType_t HrTimeEvent_hostStart(IsrPost *chanSto, uint16_t chanLen);
+#endif
+
+#endif /* FREEACT_HR_TIMER */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREE_ACT_IO_H */
@@ -0,0 +1,210 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Remote Active Object proxies over pluggable transports
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_REMOTE_H
+#define FREE_ACT_REMOTE_H
+
+#include "FreeAct.h"        /* Free Active Object interface */
+#include "stream_buffer.h"  /* FreeRTOS stream buffers (UART transport) */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Remote Active Object facilities...
+*
+* A RemoteProxy is a local AO standing for an AO on another node, so
+* posting to it with Active_post() is the same as posting to a local AO.
+* The proxy appends every event to the batch frame of its RemoteLink,
+* which sends the frame over a pluggable Transport when it is full or
+* when no proxy of the link has more events queued. Inbound frames are
+* decoded by the RemoteLink of the other node and the events are posted
+* to the AOs exported there under the ids the proxies refer to.
+*
+* Frame:  0x7E | len (2, LE) | records... | CRC-16/CCITT (2, LE)
+* Record: dst (1) | size (1) | event bytes (size)
+*
+* Events are copied as plain bytes (no pointers allowed), so the nodes
+* must share the event layout. The size of every remotable event is
+* given by the table of event sizes indexed by signal.
+*/
+
+/* maximum size of a remotable event [bytes] */
+#ifndef FREEACT_REMOTE_MAX_EVT
+#define FREEACT_REMOTE_MAX_EVT 16U
+#endif
+
+/* maximum number of AOs exported through a RemoteLink */
+#ifndef FREEACT_REMOTE_MAX_EXPORT
+#define FREEACT_REMOTE_MAX_EXPORT 8U
+#endif
+
+/* framing overhead (sync, length and CRC) [bytes] */
+#define REMOTE_FRAME_OVERHEAD 5U
+
+typedef struct Transport Transport;   /* forward declaration */
+typedef struct RemoteLink RemoteLink; /* forward declaration */
+
+/* Transport interface */
+struct Transport {
+    /* send a complete frame, pdFALSE if it does not fit (never blocks) */
+    BaseType_t (*send)(Transport * const me,
+                       uint8_t const *frame, uint16_t len);
+    RemoteLink *link;           /* the link receiving the inbound bytes */
+};
+
+/* storage for one inbound event */
+typedef union {
+    Event evt;                  /* the event */
+    void *align;                /* alignment of pointers... */
+    uint32_t align32;           /* ...and 32-bit integers */
+    uint8_t bytes[FREEACT_REMOTE_MAX_EVT];
+} RemoteSlot;
+
+/* AO exported to the remote node */
+typedef struct {
+    Active *ao;                 /* the local recipient AO */
+    RemoteSlot *slots;          /* ring of inbound events */
+    uint8_t nSlots;             /* number of slots in the ring */
+    uint8_t next;               /* next slot to use */
+} RemoteExport;
+
+/* Remote link class (one per Transport) */
+struct RemoteLink {
+    Transport *transport;       /* the transport of the link */
+    uint8_t const *evtSize;     /* event sizes by signal (0 - not remotable) */
+    Signal nSigs;               /* number of entries in evtSize[] */
+
+    uint8_t *frame;             /* outbound batch frame */
+    uint16_t frameLen;          /* size of the frame buffer */
+    uint16_t frameUsed;         /* bytes of records in the frame */
+
+    uint8_t *rxBuf;             /* inbound records being received */
+    uint16_t rxLen;             /* size of the inbound buffer */
+    uint16_t rxUsed;            /* bytes received into rxBuf */
+    uint16_t rxNeed;            /* length of the frame being received */
+    uint16_t rxCrc;             /* received CRC */
+    uint8_t rxState;            /* state of the deframer */
+
+    uint16_t txDropped;         /* frames the transport could not take */
+    uint16_t rxErrors;          /* corrupted frames and bad records */
+
+    RemoteExport exports[FREEACT_REMOTE_MAX_EXPORT];
+};
+
+void RemoteLink_ctor(RemoteLink * const me, Transport * const transport,
+                     uint8_t const *evtSize, Signal nSigs,
+                     uint8_t *frameSto, uint16_t frameLen,
+                     uint8_t *rxSto, uint16_t rxLen);
+
+/* export 'ao' under 'id'; the ring must have at least queueLen + 2 slots
+* of the AO, so that no slot is reused before the AO is done with it
+*/
+void RemoteLink_export(RemoteLink * const me, uint8_t id, Active *ao,
+                       RemoteSlot *slotSto, uint8_t nSlots);
+
+/* send the batch frame now (task context) */
+void RemoteLink_flush(RemoteLink * const me);
+
+/* inbound bytes from the transport (single receiving context) */
+void RemoteLink_onRx(RemoteLink * const me,
+                     uint8_t const *data, uint32_t len);
+
+/* Remote proxy class */
+typedef struct {
+    Active super;               /* inherit Active */
+    RemoteLink *link;           /* the link to the remote node */
+    uint8_t dst;                /* id of the AO exported on that node */
+} RemoteProxy;
+
+/* the proxy is started with Active_start(), like any other AO */
+void RemoteProxy_ctor(RemoteProxy * const me, RemoteLink *link, uint8_t dst);
+
+/*---------------------------------------------------------------------------*/
+/* Stream (UART) transport...
+*
+* The outbound frames go into the TX stream buffer, which the UART TX ISR
+* drains with StreamTransport_txFromISR() after txKick() started it. The
+* UART RX ISR feeds the RX stream buffer with StreamTransport_rxFromISR()
+* and the RX thread passes the bytes to the RemoteLink.
+* NOTE: the storage of each stream buffer must be one byte longer than
+* its length, and the FreeRTOS stream_buffer.c must be linked in.
+*/
+typedef struct {
+    Transport super;            /* inherit Transport */
+    StaticStreamBuffer_t tx_cb; /* TX stream buffer control-block */
+    StaticStreamBuffer_t rx_cb; /* RX stream buffer control-block */
+    StaticTask_t thread_cb;     /* RX thread control-block */
+    void (*txKick)(void);       /* start the UART transmission */
+} StreamTransport;
+
+/* FreeRTOS handles of the stream buffers */
+#define StreamTransport_tx(me_) ((StreamBufferHandle_t)&(me_)->tx_cb)
+#define StreamTransport_rx(me_) ((StreamBufferHandle_t)&(me_)->rx_cb)
+
+void StreamTransport_ctor(StreamTransport * const me,
+                          uint8_t *txSto, uint32_t txLen,
+                          uint8_t *rxSto, uint32_t rxLen,
+                          void (*txKick)(void));
+void StreamTransport_startRx(StreamTransport * const me,
+                             uint8_t prio,   /* priority (1-based) */
+                             void *stackSto,
+                             uint32_t stackSize);
+uint32_t StreamTransport_txFromISR(StreamTransport * const me,
+                                   uint8_t *buf, uint32_t max,
+                                   BaseType_t *pxHigherPriorityTaskWoken);
+void StreamTransport_rxFromISR(StreamTransport * const me,
+                               uint8_t const *buf, uint32_t len,
+                               BaseType_t *pxHigherPriorityTaskWoken);
+
+/*---------------------------------------------------------------------------*/
+/* In-memory loopback transport (for testing)...
+*
+* The frames are delivered synchronously to the RemoteLink of the peer
+* transport (which can be the transport itself, for a single node).
+*/
+typedef struct LoopbackTransport {
+    Transport super;            /* inherit Transport */
+    struct LoopbackTransport *peer; /* the receiving transport */
+} LoopbackTransport;
+
+void LoopbackTransport_ctor(LoopbackTransport * const me,
+                            LoopbackTransport *peer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREE_ACT_REMOTE_H */
@@ -0,0 +1,131 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Shared-memory event transport between processes (Linux)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_SHM_H
+#define FREE_ACT_SHM_H
+
+#include "FreeAct.h"    /* Free Active Object interface */
+#include "FreeAct_io.h" /* IsrChannel, for the hand-over to the AOs */
+
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Shared-memory link facilities...
+*
+* ShmLink connects two processes (side 0 and side 1) through a POSIX
+* shared-memory region holding, for each direction, an event pool, a
+* message ring and a return ring. Both rings are lock-free single-
+* producer/single-consumer rings of 32-bit entries, so an event crosses
+* the process boundary as a block index, without serialization and
+* without a system call on the fast path:
+*
+* - the sender allocates the event in its pool (ShmLink_alloc()), fills
+*   it in and posts it to an AO exported by the other side (ShmLink_post())
+* - the receiver thread hands the event over to the AO through an
+*   IsrChannel (forwarded by IsrChannel_forwardFromISR(), see FreeAct_io.h)
+*   and the AO gives the block back with ShmLink_release() when done
+*
+* The receiver thread is a native thread (not a FreeRTOS task), which
+* sleeps on a futex when the ring is empty; the sender calls futex wake
+* only when it finds the receiver idle. The producer sides of the rings
+* are serialized among the FreeRTOS tasks with the scheduler lock.
+*/
+
+/* maximum number of AOs exported through a ShmLink */
+#ifndef FREEACT_SHM_MAX_EXPORT
+#define FREEACT_SHM_MAX_EXPORT 8U
+#endif
+
+/* SPSC ring in the shared memory (the indices are free-running) */
+typedef struct {
+    uint32_t volatile head;     /* written only by the producer */
+    uint32_t pad0[15];          /* keep head and tail in own cache lines */
+    uint32_t volatile tail;     /* written only by the consumer */
+    uint32_t volatile idle;     /* consumer sleeps on it (futex word) */
+    uint32_t pad1[14];
+    uint32_t entry[1];          /* ringLen entries follow */
+} ShmRing;
+
+/* Shared-memory link class (the process-local part) */
+typedef struct {
+    uint8_t *base;              /* the mapped shared region */
+    uint32_t size;              /* size of the region [bytes] */
+    uint32_t blockSize;         /* size of the event blocks [bytes] */
+    uint32_t nBlocks;           /* number of blocks in each pool */
+    uint32_t ringLen;           /* entries in each ring (power of 2) */
+    uint8_t side;               /* 0 - creator, 1 - the other process */
+
+    ShmRing *tx;                /* events to the other side */
+    ShmRing *txRet;             /* own blocks given back by the other side */
+    uint8_t *txPool;            /* own event pool */
+    ShmRing *rx;                /* events from the other side */
+    ShmRing *rxRet;             /* blocks given back to the other side */
+    uint8_t *rxPool;            /* the pool of the other side */
+
+    uint32_t *freeBlk;          /* free blocks of the own pool */
+    uint32_t nFree;             /* number of free blocks */
+
+    Active *exports[FREEACT_SHM_MAX_EXPORT]; /* AOs by id */
+    IsrChannel chan;            /* hand-over to the AOs */
+    pthread_t rxThread;         /* the receiver thread */
+    uint32_t volatile lost;     /* events not taken by the IsrChannel */
+    uint32_t volatile retLock;  /* producer lock of rxRet (the receiver
+                                * thread and the tasks) */
+} ShmLink;
+
+/* open (side 0 creates) the named region; 'freeSto' holds nBlocks words,
+* 'chanSto' the IsrChannel ring; returns pdFALSE on failure
+*/
+BaseType_t ShmLink_open(ShmLink * const me, char const *name, uint8_t side,
+                        uint32_t blockSize, uint32_t nBlocks,
+                        uint32_t ringLen,
+                        uint32_t *freeSto,
+                        IsrPost *chanSto, uint16_t chanLen);
+void ShmLink_export(ShmLink * const me, uint8_t id, Active *ao);
+BaseType_t ShmLink_startRx(ShmLink * const me);
+
+/* task context */
+Event *ShmLink_alloc(ShmLink * const me, uint32_t size, Signal sig);
+void ShmLink_post(ShmLink * const me, uint8_t dst, Event const * const e);
+void ShmLink_release(ShmLink * const me, Event const * const e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREE_ACT_SHM_H */
@@ -0,0 +1,165 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Lightweight state machines hosted inside Active Objects
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#ifndef FREE_ACT_SM_H
+#define FREE_ACT_SM_H
+
+#include "FreeAct.h"  /* Free Active Object interface */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* State machine array facilities...
+*
+* SmArray holds N instances of the same flat state machine type, all driven
+* from the event loop of a single AO (e.g., one instance per connection).
+* The state of every instance is a single byte, stored contiguously, and
+* the instance data is kept by the application in its own arrays indexed
+* by the instance number (struct-of-arrays layout), so dispatching to an
+* instance is O(1) and a broadcast is one linear pass over the states. A
+* batch of targeted events (an array of SmEvent) is dispatched in one call.
+*/
+
+/* state handler: processes event 'e' in instance 'inst' and returns the
+* next state of the instance (the same state for no transition)
+*/
+typedef uint8_t (*SmHandler)(void * const ctx, uint16_t inst,
+                             Event const * const e);
+
+/* State machine array class */
+typedef struct {
+    uint8_t *state;            /* states of the instances */
+    SmHandler const *handlers; /* state handlers, indexed by state */
+    void *ctx;                 /* context for the handlers (e.g., the AO) */
+    uint16_t nInst;            /* number of instances */
+    uint8_t nStates;           /* number of states */
+} SmArray;
+
+/* Event targeted to one instance of an SmArray */
+typedef struct {
+    Event super;               /* inherit Event */
+    uint16_t inst;             /* the target instance */
+} SmEvent;
+
+void SmArray_ctor(SmArray * const me,
+                  uint8_t *stateSto,       /* storage for nInst states */
+                  uint16_t nInst,
+                  SmHandler const *handlers,
+                  uint8_t nStates,
+                  uint8_t initial,         /* initial state of all instances */
+                  void *ctx);
+void SmArray_dispatch(SmArray * const me, uint16_t inst,
+                      Event const * const e);
+void SmArray_dispatchBatch(SmArray * const me,
+                           uint16_t const *inst, uint16_t n,
+                           Event const * const e);
+void SmArray_broadcast(SmArray * const me, Event const * const e);
+
+/* dispatch a batch of targeted events, each to its own instance */
+void SmArray_dispatchEvents(SmArray * const me,
+                            SmEvent const *evts, uint16_t n);
+
+#define SmArray_getState(me_, inst_) ((me_)->state[(inst_)])
+
+/*---------------------------------------------------------------------------*/
+/* Orthogonal component facilities...
+*
+* ActiveContainer is an AO that owns several state machine components and
+* routes each event to them within a single RTC step, so many small,
+* loosely coupled behaviours share one task, stack and queue. Routing is
+* by signal through a table indexed by the signal: the entry is the index
+* of the component, ROUTE_ALL (all components) or ROUTE_TARGET (the event
+* is a ComponentEvent carrying the index of the target component).
+* Signals beyond the table go to all components.
+*/
+
+/* depth of the internal queue for the synchronous posts of components */
+#ifndef FREEACT_MAX_INTERNAL
+#define FREEACT_MAX_INTERNAL 4U
+#endif
+
+enum ComponentRoutes {
+    ROUTE_ALL    = 0xFFU, /* deliver to all components */
+    ROUTE_TARGET = 0xFEU  /* deliver to ComponentEvent.target */
+};
+
+typedef struct Component Component; /* forward declaration */
+typedef struct ActiveContainer ActiveContainer; /* forward declaration */
+
+typedef void (*ComponentHandler)(Component * const me, Event const * const e);
+
+/* Orthogonal component base class */
+struct Component {
+    ComponentHandler dispatch;  /* pointer to the dispatch() function */
+    ActiveContainer *container; /* the owning container AO */
+};
+
+/* Event targeted to one component of an ActiveContainer */
+typedef struct {
+    Event super;                /* inherit Event */
+    uint8_t target;             /* index of the target component */
+} ComponentEvent;
+
+/* Active Object owning orthogonal components */
+struct ActiveContainer {
+    Active super;               /* inherit Active */
+
+    Component * const *comps;   /* the components, indexed by target */
+    uint8_t const *route;       /* route table, indexed by signal */
+    Signal nRoute;              /* number of entries in the route table */
+    uint8_t nComps;             /* number of components */
+
+    /* internal FIFO of events posted synchronously by the components */
+    Event const *internal[FREEACT_MAX_INTERNAL];
+    uint8_t intHead;
+    uint8_t intTail;
+    uint8_t intUsed;
+};
+
+void Component_ctor(Component * const me, ComponentHandler dispatch);
+void Component_postContainer(Component * const me, Event const * const e);
+
+void ActiveContainer_ctor(ActiveContainer * const me,
+                          Component * const *comps, uint8_t nComps,
+                          uint8_t const *route, Signal nRoute);
+void ActiveContainer_dispatchTo(ActiveContainer * const me, uint8_t target,
+                                Event const * const e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREE_ACT_SM_H */
@@ -31,11 +31,137 @@
 * <www.state-machine.com>
 * <info@state-machine.com>
 *****************************************************************************/
+#if defined(__unix__) || defined(__APPLE__) /* POSIX host (simulation)? */
+#define _POSIX_C_SOURCE 200112L /* for clock_gettime() */
+#endif
+
 #include "FreeAct.h" /* Free Active Object interface */
 
+Active *FreeAct_active[FREEACT_MAX_ACTIVE]; /* registry of started AOs */
+uint8_t FreeAct_activeCount;                /* number of started AOs */
+
+#if (FREEACT_QUEUE != FREEACT_QUEUE_FREERTOS)
+static BaseType_t Active_insert(Active * const me, Event const * const e,
+                                FreeAct_Time deadline);
+#endif
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+static void Active_removeFirst(Active * const me);
+#endif
+
 /*..........................................................................*/
 void Active_ctor(Active * const me, DispatchHandler dispatch) {
     me->dispatch = dispatch; /* assign the dispatch handler */
+#if (FREEACT_BUDGET != 0)
+    me->budget     = 0U; /* no budget */
+    me->sigBudget  = (uint32_t const *)0;
+    me->nSigBudget = 0U;
+    me->steps      = 0U;
+    me->overruns   = 0U;
+    me->maxStep    = 0U;
+#endif
+#if (configUSE_TICKLESS_IDLE != 0)
+    me->wakeups    = 0U;
+    me->sleepTicks = 0U;
+#endif
+}
+
+#if (FREEACT_BUDGET != 0)
+/*..........................................................................*/
+void Active_setBudget(Active * const me, uint32_t budget,
+                      uint32_t const *sigBudget, Signal nSigBudget)
+{
+    me->budget     = budget;
+    me->sigBudget  = sigBudget;
+    me->nSigBudget = (sigBudget != (uint32_t const *)0) ? nSigBudget : 0U;
+}
+/*..........................................................................*/
+void Active_stepEnd(Active * const me, Event const * const e,
+                    FreeAct_Time start)
+{
+    uint32_t const elapsed = (uint32_t)(FreeAct_now() - start);
+    uint32_t budget = me->budget;
+
+    if ((e->sig < me->nSigBudget) && (me->sigBudget[e->sig] != 0U)) {
+        budget = me->sigBudget[e->sig];
+    }
+    if (elapsed > me->maxStep) {
+        me->maxStep = elapsed;
+    }
+    if ((budget != 0U) && (elapsed > budget)) {
+        ++me->overruns;
+        FreeAct_onOverrun(me, e, elapsed);
+    }
+}
+#endif
+
+/*..........................................................................*/
+/* get the next event from the AO's queue (BLOCKING!) */
+Event const *Active_get(Active * const me) {
+    Event const *e; /* pointer to event object ("message") */
+
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+    xQueueReceive(Active_queue(me), &e, portMAX_DELAY); /* BLOCKING! */
+#elif (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+    FreeAct_Time deadline;
+    for (;;) {
+        taskENTER_CRITICAL();
+        if (me->queueUsed != 0U) { /* any events in the heap? */
+            e = me->queue[0].e;
+            deadline = me->queue[0].deadline;
+            Active_removeFirst(me);
+            taskEXIT_CRITICAL();
+            break;
+        }
+        taskEXIT_CRITICAL();
+
+        /* heap empty, wait for the notification from the next post */
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY); /* BLOCKING! */
+    }
+    if ((deadline != FREEACT_NO_DEADLINE) && (FreeAct_now() > deadline)) {
+        ++me->missed; /* too late already */
+        deadline = FREEACT_NO_DEADLINE; /* count the miss only once */
+    }
+    me->deadline = deadline;
+#else
+    for (;;) {
+        taskENTER_CRITICAL();
+        if (me->queueUsed != 0U) { /* any events in the ring? */
+            e = me->queue[me->queueTail];
+            ++me->queueTail;
+            if (me->queueTail == me->queueLen) {
+                me->queueTail = 0U;
+            }
+            --me->queueUsed;
+            taskEXIT_CRITICAL();
+            break;
+        }
+        taskEXIT_CRITICAL();
+
+        /* ring empty, wait for the notification from the next post */
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY); /* BLOCKING! */
+    }
+#endif
+    return e;
+}
+
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+/*..........................................................................*/
+void Active_deadlineEnd(Active * const me) {
+    if ((me->deadline != FREEACT_NO_DEADLINE)
+        && (FreeAct_now() > me->deadline))
+    {
+        ++me->missed; /* completed too late */
+    }
+}
+#endif
+
+/*..........................................................................*/
+uint32_t Active_pending(Active * const me) {
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+    return (uint32_t)uxQueueMessagesWaiting(Active_queue(me));
+#else
+    return me->queueUsed; /* single read, no critical section needed */
+#endif
 }
 
 /*..........................................................................*/
@@ -44,131 +170,611 @@ static void Active_eventLoop(void *pvParameters) {
     Active *me = (Active *)pvParameters;
     static Event const initEvt = { INIT_SIG };
 
-    configASSERT(me); /* Active object must be provided */
+    FREEACT_ASSERT_DBG(me); /* Active object must be provided */
 
     /* initialize the AO */
     (*me->dispatch)(me, &initEvt);
 
     for (;;) {   /* for-ever "superloop" */
-        Event const *e; /* pointer to event object ("message") */
-
         /* wait for any event and receive it into object 'e' */
-        xQueueReceive(me->queue, &e, portMAX_DELAY); /* BLOCKING! */
-        configASSERT(e != (Event const *)0);
+        Event const *e = Active_get(me); /* BLOCKING! */
+        FREEACT_ASSERT_DBG(e != (Event const *)0);
+
+#if (configUSE_TICKLESS_IDLE != 0)
+        Active_claimWakeup(me);
+#endif
+
+        FREEACT_TRACE_DISPATCH(me, e);
+
+#if (FREEACT_BUDGET != 0)
+        /* measure only every FREEACT_BUDGET-th RTC step */
+        BaseType_t const sample =
+            ((++me->steps & (FREEACT_BUDGET - 1U)) == 0U) ? pdTRUE : pdFALSE;
+        FreeAct_Time const start = (sample == pdTRUE) ? FreeAct_now() : 0U;
+#endif
 
         /* dispatch event to the active object 'me' */
         (*me->dispatch)(me, e); /* NO BLOCKING! */
+
+#if (FREEACT_BUDGET != 0)
+        if (sample == pdTRUE) {
+            Active_stepEnd(me, e, start);
+        }
+#endif
+
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+        Active_deadlineEnd(me);
+#endif
     }
 }
 
 /*..........................................................................*/
 void Active_start(Active * const me,
                   uint8_t prio,       /* priority (1-based) */
-                  Event **queueSto,
+                  ActiveQueueSlot *queueSto,
                   uint32_t queueLen,
                   void *stackSto,
                   uint32_t stackSize,
                   uint16_t opt)
+{
+    (void)opt; /* unused parameter */
+    Active_startLoop(me, prio, queueSto, queueLen, stackSto, stackSize,
+                     &Active_eventLoop);
+}
+
+/*..........................................................................*/
+void Active_startLoop(Active * const me,
+                      uint8_t prio,   /* priority (1-based) */
+                      ActiveQueueSlot *queueSto,
+                      uint32_t queueLen,
+                      void *stackSto,
+                      uint32_t stackSize,
+                      TaskFunction_t loop)
 {
     StackType_t *stk_sto = stackSto;
     uint32_t stk_depth = (stackSize / sizeof(StackType_t));
+    TaskHandle_t thread;
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+    QueueHandle_t queue;
+#endif
 
-    (void)opt; /* unused parameter */
-    me->queue = xQueueCreateStatic(
+    /* the AO must fit in the registry */
+    FREEACT_ASSERT(FreeAct_activeCount < FREEACT_MAX_ACTIVE);
+    FreeAct_active[FreeAct_activeCount] = me;
+    ++FreeAct_activeCount;
+
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+    queue = xQueueCreateStatic(
                    queueLen,            /* queue length - provided by user */
                    sizeof(Event *),     /* item size */
                    (uint8_t *)queueSto, /* queue storage - provided by user */
                    &me->queue_cb);      /* queue control block */
-    configASSERT(me->queue);            /* queue must be created */
+    /* queue must be created and its handle must be the control block */
+    FREEACT_ASSERT(queue == Active_queue(me));
+    (void)queue;
+#elif (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+    FREEACT_ASSERT((queueLen > 0U) && (queueLen <= 0xFFFFU));
+    me->queue     = queueSto;
+    me->queueLen  = (uint16_t)queueLen;
+    me->queueUsed = 0U;
+    me->queueSeq  = 0U;
+    me->deadline  = FREEACT_NO_DEADLINE;
+    me->missed    = 0U;
+#else
+    FREEACT_ASSERT((queueLen > 0U) && (queueLen <= 0xFFFFU));
+    me->queue     = (Event const **)queueSto;
+    me->queueLen  = (uint16_t)queueLen;
+    me->queueHead = 0U;
+    me->queueTail = 0U;
+    me->queueUsed = 0U;
+#endif
 
-    me->thread = xTaskCreateStatic(
-              &Active_eventLoop,        /* the thread function */
+    thread = xTaskCreateStatic(
+              loop,                     /* the thread function */
               "AO" ,                    /* the name of the task */
               stk_depth,                /* stack depth */
               me,                       /* the 'pvParameters' parameter */
               prio + tskIDLE_PRIORITY,  /* FreeRTOS priority */
               stk_sto,                  /* stack storage - provided by user */
               &me->thread_cb);          /* task control block */
-    configASSERT(me->thread);           /* thread must be created */
+    /* thread must be created and its handle must be the control block */
+    FREEACT_ASSERT(thread == Active_thread(me));
+    (void)thread;
+}
+
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+/*..........................................................................*/
+/* heap order: earlier deadline first, then earlier post */
+static BaseType_t Active_earlier(ActiveQueueSlot const * const a,
+                                 ActiveQueueSlot const * const b)
+{
+    if (a->deadline != b->deadline) {
+        return (a->deadline < b->deadline) ? pdTRUE : pdFALSE;
+    }
+    return ((int32_t)(a->seq - b->seq) < 0) ? pdTRUE : pdFALSE;
+}
+/*..........................................................................*/
+/* insert event into the heap (call inside a critical section),
+* returns pdTRUE if the heap was empty, so the AO needs to be notified
+*/
+static BaseType_t Active_insert(Active * const me, Event const * const e,
+                                FreeAct_Time deadline)
+{
+    BaseType_t wasEmpty = (me->queueUsed == 0U) ? pdTRUE : pdFALSE;
+    ActiveQueueSlot * const heap = me->queue;
+    ActiveQueueSlot slot;
+    uint16_t i;
+
+    FREEACT_ASSERT(me->queueUsed < me->queueLen); /* heap must not overflow */
+    slot.deadline = deadline;
+    slot.e        = e;
+    slot.seq      = me->queueSeq;
+    ++me->queueSeq;
+
+    /* sift up from the new leaf */
+    for (i = me->queueUsed; i > 0U; ) {
+        uint16_t const parent = (uint16_t)((i - 1U) >> 1);
+        if (Active_earlier(&slot, &heap[parent]) != pdTRUE) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = slot;
+    ++me->queueUsed;
+    return wasEmpty;
+}
+/*..........................................................................*/
+/* remove the root of the heap (call inside a critical section) */
+static void Active_removeFirst(Active * const me) {
+    ActiveQueueSlot * const heap = me->queue;
+    uint16_t const n = --me->queueUsed;
+    ActiveQueueSlot const * const last = &heap[n];
+    uint16_t i = 0U;
+
+    /* sift the last element down from the root */
+    for (;;) {
+        uint16_t child = (uint16_t)((i << 1) + 1U);
+        if (child >= n) {
+            break;
+        }
+        if (((child + 1U) < n)
+            && (Active_earlier(&heap[child + 1U], &heap[child]) == pdTRUE))
+        {
+            ++child;
+        }
+        if (Active_earlier(&heap[child], last) != pdTRUE) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = *last;
 }
 
+#elif (FREEACT_QUEUE == FREEACT_QUEUE_NOTIFY)
+/*..........................................................................*/
+/* insert event into the ring (call inside a critical section),
+* returns pdTRUE if the ring was empty, so the AO needs to be notified
+*/
+static BaseType_t Active_insert(Active * const me, Event const * const e,
+                                FreeAct_Time deadline)
+{
+    BaseType_t wasEmpty = (me->queueUsed == 0U) ? pdTRUE : pdFALSE;
+
+    (void)deadline; /* FIFO */
+
+    FREEACT_ASSERT(me->queueUsed < me->queueLen); /* ring must not overflow */
+    me->queue[me->queueHead] = e;
+    ++me->queueHead;
+    if (me->queueHead == me->queueLen) {
+        me->queueHead = 0U;
+    }
+    ++me->queueUsed;
+    return wasEmpty;
+}
+#endif
+
 /*..........................................................................*/
 void Active_post(Active * const me, Event const * const e) {
-    BaseType_t status = xQueueSendToBack(me->queue, (void *)&e, (TickType_t)0);
-    configASSERT(status == pdTRUE);
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+    BaseType_t status;
+    FREEACT_TRACE_POST(me, e);
+    status = xQueueSendToBack(Active_queue(me), (void *)&e, (TickType_t)0);
+    FREEACT_ASSERT(status == pdTRUE);
+#else
+    BaseType_t wasEmpty;
+    FREEACT_TRACE_POST(me, e);
+    taskENTER_CRITICAL();
+    wasEmpty = Active_insert(me, e, FREEACT_NO_DEADLINE);
+    taskEXIT_CRITICAL();
+    if (wasEmpty == pdTRUE) {
+        xTaskNotifyGive(Active_thread(me));
+    }
+#endif
 }
 
 /*..........................................................................*/
 void Active_postFromISR(Active * const me, Event const * const e,
                         BaseType_t *pxHigherPriorityTaskWoken)
 {
-    BaseType_t status = xQueueSendToBackFromISR(me->queue, (void *)&e,
-                                                pxHigherPriorityTaskWoken);
-    configASSERT(status == pdTRUE);
+#if (FREEACT_QUEUE == FREEACT_QUEUE_FREERTOS)
+    BaseType_t status;
+    FREEACT_TRACE_POST(me, e);
+    status = xQueueSendToBackFromISR(Active_queue(me), (void *)&e,
+                                     pxHigherPriorityTaskWoken);
+    FREEACT_ASSERT(status == pdTRUE);
+#else
+    BaseType_t wasEmpty;
+    UBaseType_t saved;
+    FREEACT_TRACE_POST(me, e);
+    saved = taskENTER_CRITICAL_FROM_ISR();
+    wasEmpty = Active_insert(me, e, FREEACT_NO_DEADLINE);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+    if (wasEmpty == pdTRUE) {
+        vTaskNotifyGiveFromISR(Active_thread(me),
+                               pxHigherPriorityTaskWoken);
+    }
+#endif
 }
 
+#if (FREEACT_QUEUE == FREEACT_QUEUE_EDF)
+/*..........................................................................*/
+void Active_postDeadline(Active * const me, Event const * const e,
+                         FreeAct_Time deadline)
+{
+    BaseType_t wasEmpty;
+    FREEACT_TRACE_POST(me, e);
+    taskENTER_CRITICAL();
+    wasEmpty = Active_insert(me, e, deadline);
+    taskEXIT_CRITICAL();
+    if (wasEmpty == pdTRUE) {
+        xTaskNotifyGive(Active_thread(me));
+    }
+}
+
+/*..........................................................................*/
+void Active_postDeadlineFromISR(Active * const me, Event const * const e,
+                                FreeAct_Time deadline,
+                                BaseType_t *pxHigherPriorityTaskWoken)
+{
+    BaseType_t wasEmpty;
+    UBaseType_t saved;
+    FREEACT_TRACE_POST(me, e);
+    saved = taskENTER_CRITICAL_FROM_ISR();
+    wasEmpty = Active_insert(me, e, deadline);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+    if (wasEmpty == pdTRUE) {
+        vTaskNotifyGiveFromISR(Active_thread(me),
+                               pxHigherPriorityTaskWoken);
+    }
+}
+#endif /* FREEACT_QUEUE_EDF */
+
 /*--------------------------------------------------------------------------*/
 /* Time Event services... */
 static void TimeEvent_callback(TimerHandle_t xTimer);
 
 /*..........................................................................*/
 void TimeEvent_ctor(TimeEvent * const me, Signal sig, Active *act) {
+    /* the AO is the timer ID */
+    TimeEvent_init(me, sig, act, &TimeEvent_callback);
+}
+/*..........................................................................*/
+void TimeEvent_init(TimeEvent * const me, Signal sig, void *timerId,
+                    TimerCallbackFunction_t callback)
+{
     /* no critical section because it is presumed that all TimeEvents
      * are created *before* multitasking has started.
      */
+    TimerHandle_t timer;
+
     me->super.sig = sig;
-    me->act = act;
+    me->armed     = 0U;
+    me->deadline  = 0U;
+    me->interval  = 0U;
+    me->frac      = 0U;
+    me->acc       = 0U;
+    me->slack     = 0U;
 
-    /* Create a timer object */
-    me->timer = xTimerCreateStatic("TE", 1U, me->type, me,
-                                   TimeEvent_callback, &me->timer_cb);
-    configASSERT(me->timer);            /* timer must be created */
+    /* Create a one-shot timer object (re-armed for periodic expiries) */
+    timer = xTimerCreateStatic("TE", 1U, pdFALSE, timerId,
+                               callback, &me->timer_cb);
+    /* timer must be created and its handle must be the control block */
+    FREEACT_ASSERT(timer == TimeEvent_timer(me));
+    (void)timer;
 }
 
 /*..........................................................................*/
-void TimeEvent_arm(TimeEvent * const me, uint32_t millisec) {
-    TickType_t ticks;
-    BaseType_t status;
-    BaseType_t xHigherPriorityTaskWoken;
-
-    ticks = (millisec / portTICK_PERIOD_MS);
+TickType_t FreeAct_msToTicks(uint32_t millisec) {
+    TickType_t ticks = (millisec / portTICK_PERIOD_MS);
     if (ticks == 0U) {
         ticks = 1U;
     }
+    return ticks;
+}
 
-    if (xPortIsInsideInterrupt() == pdTRUE) {
-        xHigherPriorityTaskWoken = pdFALSE;
+/*..........................................................................*/
+/* ISR context facilities... */
+static FreeAct_Isr *l_isrCurrent; /* context of the running ISR, if any */
+
+void FreeAct_isrEnter(FreeAct_Isr * const isr) {
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    isr->xHigherPriorityTaskWoken = pdFALSE;
+    isr->prev = l_isrCurrent;
+    l_isrCurrent = isr;
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+/*..........................................................................*/
+void FreeAct_isrExit(FreeAct_Isr * const isr) {
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    FREEACT_ASSERT_DBG(l_isrCurrent == isr);
+    l_isrCurrent = isr->prev;
+    if (isr->prev != (FreeAct_Isr *)0) { /* nested ISR? */
+        /* merge into the preempted ISR, which will yield on its exit */
+        if (isr->xHigherPriorityTaskWoken != pdFALSE) {
+            isr->prev->xHigherPriorityTaskWoken = pdTRUE;
+            isr->xHigherPriorityTaskWoken = pdFALSE;
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    /* the only context switch request for the whole ISR */
+    portEND_SWITCHING_ISR(isr->xHigherPriorityTaskWoken);
+}
+
+#if (FREEACT_ISR_DETECT != 0)
+/* where the implicit "FromISR" calls accumulate: the context of the
+* running ISR, if FreeAct_isrEnter() was called, or else the caller's own
+*/
+static BaseType_t *FreeAct_isrWoken(BaseType_t *pxLocal) {
+    return (l_isrCurrent != (FreeAct_Isr *)0)
+           ? &l_isrCurrent->xHigherPriorityTaskWoken
+           : pxLocal;
+}
+#endif
 
-        status = xTimerChangePeriodFromISR(me->timer, ticks,
-                                           &xHigherPriorityTaskWoken);
-        configASSERT(status == pdPASS);
+/*..........................................................................*/
+/* the tick of the timer expiry: the deadline rounded up to a multiple of
+* the largest power of 2 not exceeding slack+1, i.e., at most 'slack' late
+*/
+static TickType_t TimeEvent_expiry(TimeEvent const * const me) {
+    TickType_t grid = 1U;
+    while (grid <= (me->slack - grid + 1U)) { /* 2*grid - 1 <= slack? */
+        grid <<= 1;
+    }
+    return (me->deadline + (grid - 1U)) & ~(grid - 1U);
+}
+/*..........................................................................*/
+/* set the expiries and (re)start the timer (in a critical section), so
+* that the TimeEvent state and the order of the timer commands agree
+*/
+static void TimeEvent_set(TimeEvent * const me,
+                          TickType_t first, TickType_t interval, uint32_t frac,
+                          TickType_t slack,
+                          BaseType_t *pxHigherPriorityTaskWoken)
+{
+    TickType_t const now = xTaskGetTickCountFromISR();
+    BaseType_t status;
 
+    FREEACT_ASSERT(first > 0U);
+    FREEACT_ASSERT(slack <= (portMAX_DELAY >> 2));
+    me->deadline = now + first;
+    me->interval = interval;
+    me->frac     = frac;
+    me->acc      = 0U;
+    me->slack    = slack;
+    me->armed    = 1U;
+    status = xTimerChangePeriodFromISR(TimeEvent_timer(me),
+                                       TimeEvent_expiry(me) - now,
+                                       pxHigherPriorityTaskWoken);
+    FREEACT_ASSERT(status == pdPASS);
+}
+/*..........................................................................*/
+static void TimeEvent_setTask(TimeEvent * const me,
+                              TickType_t first, TickType_t interval,
+                              uint32_t frac, TickType_t slack)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+#if (FREEACT_ISR_DETECT != 0)
+    if (xPortIsInsideInterrupt() == pdTRUE) {
+        BaseType_t * const pxWoken =
+            FreeAct_isrWoken(&xHigherPriorityTaskWoken);
+        UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        TimeEvent_set(me, first, interval, frac, slack, pxWoken);
+        taskEXIT_CRITICAL_FROM_ISR(saved);
         portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+        return;
+    }
+#endif
+    taskENTER_CRITICAL();
+    TimeEvent_set(me, first, interval, frac, slack,
+                  &xHigherPriorityTaskWoken);
+    taskEXIT_CRITICAL();
+    if (xHigherPriorityTaskWoken != pdFALSE) {
+        taskYIELD(); /* the timer task has a higher priority */
+    }
+}
+/*..........................................................................*/
+static void TimeEvent_setFromISR(TimeEvent * const me,
+                                 TickType_t first, TickType_t interval,
+                                 uint32_t frac, TickType_t slack,
+                                 BaseType_t *pxHigherPriorityTaskWoken)
+{
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    TimeEvent_set(me, first, interval, frac, slack,
+                  pxHigherPriorityTaskWoken);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+/*..........................................................................*/
+/* microseconds in ticks, the remainder in 1e-6 tick */
+static TickType_t TimeEvent_usTicks(uint32_t us, uint32_t *frac) {
+    uint64_t const n = (uint64_t)us * configTICK_RATE_HZ;
+    *frac = (uint32_t)(n % 1000000U);
+    return (TickType_t)(n / 1000000U);
+}
+
+/*..........................................................................*/
+void TimeEvent_arm(TimeEvent * const me, uint32_t millisec) {
+    TimeEvent_setTask(me, FreeAct_msToTicks(millisec), 0U, 0U, 0U);
+}
+/*..........................................................................*/
+void TimeEvent_armFromISR(TimeEvent * const me, uint32_t millisec,
+                          BaseType_t *pxHigherPriorityTaskWoken)
+{
+    TimeEvent_setFromISR(me, FreeAct_msToTicks(millisec), 0U, 0U, 0U,
+                         pxHigherPriorityTaskWoken);
+}
+/*..........................................................................*/
+void TimeEvent_armX(TimeEvent * const me,
+                    TickType_t firstTicks, TickType_t intervalTicks)
+{
+    TimeEvent_setTask(me, firstTicks, intervalTicks, 0U, 0U);
+}
+/*..........................................................................*/
+void TimeEvent_armXFromISR(TimeEvent * const me,
+                           TickType_t firstTicks, TickType_t intervalTicks,
+                           BaseType_t *pxHigherPriorityTaskWoken)
+{
+    TimeEvent_setFromISR(me, firstTicks, intervalTicks, 0U, 0U,
+                         pxHigherPriorityTaskWoken);
+}
+/*..........................................................................*/
+void TimeEvent_armUs(TimeEvent * const me,
+                     uint32_t firstUs, uint32_t intervalUs)
+{
+    uint32_t frac;
+    TickType_t first = TimeEvent_usTicks(firstUs, &frac);
+    TickType_t const interval = TimeEvent_usTicks(intervalUs, &frac);
+
+    FREEACT_ASSERT((intervalUs == 0U) || (interval > 0U)); /* >= 1 tick */
+    if (first == 0U) {
+        first = 1U;
     }
-    else {
-        status = xTimerChangePeriod(me->timer, ticks, 0);
-        configASSERT(status == pdPASS);
+    TimeEvent_setTask(me, first, interval, frac, 0U);
+}
+/*..........................................................................*/
+void TimeEvent_armUsFromISR(TimeEvent * const me,
+                            uint32_t firstUs, uint32_t intervalUs,
+                            BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint32_t frac;
+    TickType_t first = TimeEvent_usTicks(firstUs, &frac);
+    TickType_t const interval = TimeEvent_usTicks(intervalUs, &frac);
+
+    FREEACT_ASSERT((intervalUs == 0U) || (interval > 0U)); /* >= 1 tick */
+    if (first == 0U) {
+        first = 1U;
     }
+    TimeEvent_setFromISR(me, first, interval, frac, 0U,
+                         pxHigherPriorityTaskWoken);
+}
+/*..........................................................................*/
+void TimeEvent_armSlack(TimeEvent * const me,
+                        uint32_t millisec, uint32_t slackMs)
+{
+    TimeEvent_setTask(me, FreeAct_msToTicks(millisec), 0U, 0U,
+                      slackMs / portTICK_PERIOD_MS);
+}
+/*..........................................................................*/
+void TimeEvent_armSlackFromISR(TimeEvent * const me,
+                               uint32_t millisec, uint32_t slackMs,
+                               BaseType_t *pxHigherPriorityTaskWoken)
+{
+    TimeEvent_setFromISR(me, FreeAct_msToTicks(millisec), 0U, 0U,
+                         slackMs / portTICK_PERIOD_MS,
+                         pxHigherPriorityTaskWoken);
+}
+/*..........................................................................*/
+void TimeEvent_armXSlack(TimeEvent * const me,
+                         TickType_t firstTicks, TickType_t intervalTicks,
+                         TickType_t slackTicks)
+{
+    TimeEvent_setTask(me, firstTicks, intervalTicks, 0U, slackTicks);
+}
+/*..........................................................................*/
+void TimeEvent_armXSlackFromISR(TimeEvent * const me,
+                                TickType_t firstTicks,
+                                TickType_t intervalTicks,
+                                TickType_t slackTicks,
+                                BaseType_t *pxHigherPriorityTaskWoken)
+{
+    TimeEvent_setFromISR(me, firstTicks, intervalTicks, 0U, slackTicks,
+                         pxHigherPriorityTaskWoken);
 }
 
 /*..........................................................................*/
 void TimeEvent_disarm(TimeEvent * const me) {
-    BaseType_t xHigherPriorityTaskWoken;
-    BaseType_t status;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+#if (FREEACT_ISR_DETECT != 0)
     if (xPortIsInsideInterrupt() == pdTRUE) {
-        xHigherPriorityTaskWoken = pdFALSE;
-        status = xTimerStopFromISR(me->timer, &xHigherPriorityTaskWoken);
-        configASSERT(status == pdPASS);
-
+        TimeEvent_disarmFromISR(me,
+                                FreeAct_isrWoken(&xHigherPriorityTaskWoken));
         portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+        return;
     }
-    else {
-        status = xTimerStop(me->timer, 0);
-        configASSERT(status == pdPASS);
+#endif
+    taskENTER_CRITICAL();
+    TimeEvent_disarmFromISR(me, &xHigherPriorityTaskWoken);
+    taskEXIT_CRITICAL();
+    if (xHigherPriorityTaskWoken != pdFALSE) {
+        taskYIELD(); /* the timer task has a higher priority */
     }
 }
 
+/*..........................................................................*/
+void TimeEvent_disarmFromISR(TimeEvent * const me,
+                             BaseType_t *pxHigherPriorityTaskWoken)
+{
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    BaseType_t status;
+
+    me->armed = 0U; /* an expiry already in progress won't post */
+    status = xTimerStopFromISR(TimeEvent_timer(me),
+                               pxHigherPriorityTaskWoken);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+    FREEACT_ASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+BaseType_t TimeEvent_expire(TimeEvent * const me) {
+    BaseType_t post = pdFALSE;
+    TickType_t now;
+
+    taskENTER_CRITICAL();
+    now = xTaskGetTickCount();
+    /* still armed and not re-armed for a later deadline meanwhile? */
+    if ((me->armed != 0U) && ((int32_t)(now - me->deadline) >= 0)) {
+        post = pdTRUE;
+        if (me->interval == 0U) { /* one-shot? */
+            me->armed = 0U;
+        }
+        else {
+            BaseType_t status;
+            TickType_t left;
+
+            /* the next deadline from the previous one (no drift) */
+            me->deadline += me->interval;
+            me->acc += me->frac;
+            if (me->acc >= 1000000U) { /* a whole tick accumulated? */
+                me->acc -= 1000000U;
+                ++me->deadline;
+            }
+            left = TimeEvent_expiry(me) - now;
+            if ((int32_t)left <= 0) { /* overrun? catch up */
+                left = 1U;
+            }
+            status = xTimerChangePeriodFromISR(TimeEvent_timer(me), left,
+                                               (BaseType_t *)0);
+            FREEACT_ASSERT(status == pdPASS);
+        }
+    }
+    taskEXIT_CRITICAL();
+    return post;
+}
+
 /*..........................................................................*/
 /* Use this macro to get the container of TimeEvent struct
  *  since xTimer pointing to timer_cb
@@ -177,11 +783,566 @@ void TimeEvent_disarm(TimeEvent * const me) {
     (TimeEvent*)((uintptr_t)(ptr) - offsetof(TimeEvent, timer_cb))
 
 static void TimeEvent_callback(TimerHandle_t xTimer) {
-    /* Also can use pvTimerGetTimerID(xTimer) */
     TimeEvent * const t = GET_TIME_EVENT_HEAD(xTimer);
 
     /* Callback always called from non-interrupt context so no need
      * to check xPortIsInsideInterrupt
      */
-    Active_post(t->act, &t->super);
+    if (TimeEvent_expire(t) == pdTRUE) {
+        Active_post((Active *)pvTimerGetTimerID(xTimer), &t->super);
+    }
+}
+
+/*..........................................................................*/
+/* forward declarations */
+static void FreeAct_timeTick(void);
+static void FreeAct_timedTick(BaseType_t *pxHigherPriorityTaskWoken);
+
+void TimeEvent_tickFromISR(BaseType_t *pxHigherPriorityTaskWoken) {
+    FreeAct_timeTick(); /* advance the high-resolution time base */
+    FreeAct_timedTick(pxHigherPriorityTaskWoken); /* post the due events */
+}
+
+/*--------------------------------------------------------------------------*/
+/* Timed post services... */
+static TimedPost *l_timed;      /* pool of timed posts */
+static uint16_t *l_timedHeap;   /* heap of pool indexes, then the free ones */
+static uint16_t l_timedLen;     /* length of the pool */
+static uint16_t l_timedUsed;    /* timed posts pending (size of the heap) */
+
+/*..........................................................................*/
+/* heap order: earlier due tick first (wrap-around safe) */
+static BaseType_t FreeAct_timedEarlier(uint16_t a, uint16_t b) {
+    return ((int32_t)(l_timed[a].due - l_timed[b].due) < 0) ? pdTRUE : pdFALSE;
+}
+/*..........................................................................*/
+/* sift timed post 'idx' up from the hole at 'pos' (in a critical section) */
+static void FreeAct_timedSiftUp(uint16_t pos, uint16_t idx) {
+    while (pos > 0U) {
+        uint16_t const parent = (uint16_t)((pos - 1U) >> 1);
+        if (FreeAct_timedEarlier(idx, l_timedHeap[parent]) != pdTRUE) {
+            break;
+        }
+        l_timedHeap[pos] = l_timedHeap[parent];
+        l_timed[l_timedHeap[pos]].pos = pos;
+        pos = parent;
+    }
+    l_timedHeap[pos] = idx;
+    l_timed[idx].pos = pos;
+}
+/*..........................................................................*/
+/* sift timed post 'idx' down from the hole at 'pos' (in a critical section) */
+static void FreeAct_timedSiftDown(uint16_t pos, uint16_t idx) {
+    uint16_t const n = l_timedUsed;
+    for (;;) {
+        uint16_t child = (uint16_t)((pos << 1) + 1U);
+        if (child >= n) {
+            break;
+        }
+        if (((child + 1U) < n)
+            && (FreeAct_timedEarlier(l_timedHeap[child + 1U],
+                                     l_timedHeap[child]) == pdTRUE))
+        {
+            ++child;
+        }
+        if (FreeAct_timedEarlier(l_timedHeap[child], idx) != pdTRUE) {
+            break;
+        }
+        l_timedHeap[pos] = l_timedHeap[child];
+        l_timed[l_timedHeap[pos]].pos = pos;
+        pos = child;
+    }
+    l_timedHeap[pos] = idx;
+    l_timed[idx].pos = pos;
+}
+/*..........................................................................*/
+/* remove timed post 'idx' from the heap (in a critical section) */
+static void FreeAct_timedRemove(uint16_t idx) {
+    uint16_t const pos = l_timed[idx].pos;
+    uint16_t const last = l_timedHeap[--l_timedUsed];
+
+    l_timedHeap[l_timedUsed] = idx; /* back among the free indexes */
+    if (last != idx) { /* the last element fills the hole */
+        if ((pos > 0U)
+            && (FreeAct_timedEarlier(last,
+                    l_timedHeap[(pos - 1U) >> 1]) == pdTRUE))
+        {
+            FreeAct_timedSiftUp(pos, last);
+        }
+        else {
+            FreeAct_timedSiftDown(pos, last);
+        }
+    }
+}
+/*..........................................................................*/
+void FreeAct_timedInit(TimedPost *sto, uint16_t *heapSto, uint16_t len) {
+    uint16_t i;
+
+    l_timed     = sto;
+    l_timedHeap = heapSto;
+    l_timedLen  = len;
+    l_timedUsed = 0U;
+    for (i = 0U; i < len; ++i) {
+        heapSto[i] = i; /* all timed posts free */
+        sto[i].gen = 0U;
+    }
+}
+/*..........................................................................*/
+TimedHandle Active_postIn(Active * const me, Event const * const e,
+                          uint32_t millisec)
+{
+    return Active_postEvery(me, e, millisec, 0U);
+}
+/*..........................................................................*/
+TimedHandle Active_postEvery(Active * const me, Event const * const e,
+                             uint32_t firstMs, uint32_t intervalMs)
+{
+    TimedHandle h;
+    TimedPost *t;
+    uint16_t idx;
+
+    taskENTER_CRITICAL();
+    FREEACT_ASSERT(l_timedUsed < l_timedLen); /* pool must not overflow */
+    idx = l_timedHeap[l_timedUsed]; /* the first free timed post */
+    t = &l_timed[idx];
+    t->ao       = me;
+    t->e        = e;
+    t->due      = xTaskGetTickCount() + FreeAct_msToTicks(firstMs);
+    t->interval = (intervalMs != 0U) ? FreeAct_msToTicks(intervalMs) : 0U;
+    ++t->gen;
+    if (t->gen == 0U) { /* generation 0 would allow the handle 0 */
+        t->gen = 1U;
+    }
+    h = ((TimedHandle)t->gen << 16) | idx;
+    FreeAct_timedSiftUp(l_timedUsed, idx);
+    ++l_timedUsed;
+    taskEXIT_CRITICAL();
+    return h;
+}
+/*..........................................................................*/
+BaseType_t Active_postCancel(TimedHandle h) {
+    uint16_t const idx = (uint16_t)(h & 0xFFFFU);
+    BaseType_t pending = pdFALSE;
+
+    taskENTER_CRITICAL();
+    if (idx < l_timedLen) {
+        TimedPost const * const t = &l_timed[idx];
+        if ((t->gen == (uint16_t)(h >> 16))
+            && (t->pos < l_timedUsed) && (l_timedHeap[t->pos] == idx))
+        {
+            FreeAct_timedRemove(idx);
+            pending = pdTRUE;
+        }
+    }
+    taskEXIT_CRITICAL();
+    return pending;
+}
+/*..........................................................................*/
+/* post all due timed posts (from the tick hook) */
+static void FreeAct_timedTick(BaseType_t *pxHigherPriorityTaskWoken) {
+    TickType_t const now = xTaskGetTickCountFromISR();
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+
+    while ((l_timedUsed != 0U)
+           && ((int32_t)(now - l_timed[l_timedHeap[0]].due) >= 0))
+    {
+        uint16_t const idx = l_timedHeap[0];
+        TimedPost * const t = &l_timed[idx];
+
+        Active_postFromISR(t->ao, t->e, pxHigherPriorityTaskWoken);
+        if (t->interval != 0U) { /* periodic? */
+            t->due += t->interval; /* from the previous due tick (no drift) */
+            FreeAct_timedSiftDown(0U, idx);
+        }
+        else {
+            FreeAct_timedRemove(idx);
+        }
+    }
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+/*--------------------------------------------------------------------------*/
+/* Tickless idle services... */
+#if (configUSE_TICKLESS_IDLE != 0)
+
+/* forward declarations */
+static void FreeAct_timeSleepBegin(void);
+static void FreeAct_timeSleepEnd(TickType_t stepped);
+
+uint32_t FreeAct_sleepCount;
+uint32_t FreeAct_sleepTicks;
+
+static TickType_t l_sleepStart; /* tick count when the sleep began */
+static TickType_t volatile l_sleepWake; /* last sleep, not claimed yet */
+
+/*..........................................................................*/
+TickType_t FreeAct_sleepBegin(TickType_t expectedIdle) {
+    TickType_t ticks = FreeAct_onSleep(expectedIdle); /* the I/O needs */
+
+    if (ticks > expectedIdle) {
+        ticks = expectedIdle; /* the next task/TimeEvent wake-up */
+    }
+    taskENTER_CRITICAL();
+    if (l_timedUsed != 0U) { /* the next timed post is due before? */
+        TickType_t const left =
+            l_timed[l_timedHeap[0]].due - xTaskGetTickCount();
+        if ((int32_t)left <= 0) {
+            ticks = 0U;
+        }
+        else if (left < ticks) {
+            ticks = left;
+        }
+    }
+    taskEXIT_CRITICAL();
+    if (ticks != 0U) {
+        l_sleepStart = xTaskGetTickCount();
+        FreeAct_timeSleepBegin();
+    }
+    return ticks;
+}
+/*..........................................................................*/
+void FreeAct_sleepEnd(void) {
+    /* the kernel has stepped the tick count over the suppressed ticks */
+    TickType_t const slept = xTaskGetTickCount() - l_sleepStart;
+
+    taskENTER_CRITICAL();
+    if (slept != 0U) { /* not abandoned? */
+        FreeAct_timeSleepEnd(slept);
+        ++FreeAct_sleepCount;
+        FreeAct_sleepTicks += slept;
+        l_sleepWake = slept; /* to be claimed by the AO woken up */
+    }
+    taskEXIT_CRITICAL();
+}
+/*..........................................................................*/
+void Active_claimWakeup(Active * const me) {
+    if (l_sleepWake != 0U) { /* cheap test first, outside the crit. sect. */
+        taskENTER_CRITICAL();
+        if (l_sleepWake != 0U) { /* still not claimed by another AO? */
+            ++me->wakeups;
+            me->sleepTicks += l_sleepWake;
+            l_sleepWake = 0U;
+        }
+        taskEXIT_CRITICAL();
+    }
+}
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+/*--------------------------------------------------------------------------*/
+/* High-resolution time services... */
+#if defined(__unix__) || defined(__APPLE__) /* POSIX host (simulation)? */
+
+#include <time.h>
+
+/*..........................................................................*/
+FreeAct_Time FreeAct_now(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((FreeAct_Time)ts.tv_sec * 1000000000U) + (FreeAct_Time)ts.tv_nsec;
 }
+/*..........................................................................*/
+uint32_t FreeAct_timeFreq(void) {
+    return 1000000000U; /* nanoseconds */
+}
+/*..........................................................................*/
+static void FreeAct_timeTick(void) {
+    /* CLOCK_MONOTONIC needs no help from the tick */
+}
+#if (configUSE_TICKLESS_IDLE != 0)
+/*..........................................................................*/
+static void FreeAct_timeSleepBegin(void) {
+    /* CLOCK_MONOTONIC keeps counting in the sleep */
+}
+/*..........................................................................*/
+static void FreeAct_timeSleepEnd(TickType_t stepped) {
+    (void)stepped;
+}
+#endif
+
+#else /* Cortex-M target */
+
+/* Cortex-M core registers (common to all CMSIS devices) */
+#define SYST_RVR   (*(uint32_t volatile *)0xE000E014U)
+#define SYST_CVR   (*(uint32_t volatile *)0xE000E018U)
+#define SCB_ICSR   (*(uint32_t volatile *)0xE000ED04U)
+#define ICSR_PENDSTSET (1UL << 26)
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+    || defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+    #define FREEACT_TIME_DWT /* the core has the DWT cycle counter */
+
+    #define DWT_CTRL   (*(uint32_t volatile *)0xE0001000U)
+    #define DWT_CYCCNT (*(uint32_t volatile *)0xE0001004U)
+    #define DWT_LAR    (*(uint32_t volatile *)0xE0001FB0U)
+    #define DEMCR      (*(uint32_t volatile *)0xE000EDFCU)
+#endif
+
+/* Time base captured at every system clock tick. Two copies are kept and
+ * selected by the parity of l_timeSeq. The tick writes the copy that
+ * is not current, so a FreeAct_now() preempting the update (e.g., from an
+ * ISR above configMAX_SYSCALL_INTERRUPT_PRIORITY) reads a consistent copy
+ * and never spins.
+ */
+typedef struct {
+    FreeAct_Time base; /* time at the last tick */
+    uint32_t stamp;    /* raw free-running counter at the last tick */
+} TimeBase;
+
+static TimeBase volatile l_timeBase[2];
+static uint32_t volatile l_timeSeq;
+static uint8_t l_timeStarted;
+
+/*..........................................................................*/
+static void FreeAct_timeTick(void) {
+    uint32_t seq = l_timeSeq;
+    TimeBase volatile const *prev = &l_timeBase[seq & 1U];
+    TimeBase volatile *next = &l_timeBase[(seq + 1U) & 1U];
+
+    if (l_timeStarted == 0U) { /* first tick? */
+        l_timeStarted = 1U;
+#ifdef FREEACT_TIME_DWT
+        DEMCR |= (1UL << 24);   /* TRCENA: enable the DWT block */
+        DWT_LAR = 0xC5ACCE55U;  /* unlock DWT (needed on Cortex-M7) */
+        DWT_CYCCNT = 0U;
+        DWT_CTRL |= 1U;         /* CYCCNTENA: start the cycle counter */
+#endif
+        return; /* time starts at zero on the first tick */
+    }
+
+#ifdef FREEACT_TIME_DWT
+    {
+        uint32_t now = DWT_CYCCNT;
+        /* the delta is at most a few ticks, so it never wraps around */
+        next->base  = prev->base + (uint32_t)(now - prev->stamp);
+        next->stamp = now;
+    }
+#else
+    next->base = prev->base + (SYST_RVR + 1U); /* one full SysTick period */
+#endif
+    portMEMORY_BARRIER();
+    l_timeSeq = seq + 1U; /* publish the new copy */
+}
+#if (configUSE_TICKLESS_IDLE != 0)
+/* time base when the tickless sleep began */
+static FreeAct_Time l_sleepBase;
+static uint32_t l_sleepSeq;
+
+/*..........................................................................*/
+static void FreeAct_timeSleepBegin(void) {
+    taskENTER_CRITICAL();
+    l_sleepSeq  = l_timeSeq;
+    l_sleepBase = l_timeBase[l_sleepSeq & 1U].base;
+    taskEXIT_CRITICAL();
+}
+/*..........................................................................*/
+/* re-base the time after the sleep (in a critical section)
+* NOTE: neither the SysTick periods nor (in the deeper sleep modes) the
+* DWT cycle counter can be trusted across the sleep. The time base is
+* advanced by the ticks since the sleep began: the ticks the kernel
+* stepped over plus the ticks that ran the tick hook meanwhile.
+*/
+static void FreeAct_timeSleepEnd(TickType_t stepped) {
+    uint32_t seq = l_timeSeq;
+    TimeBase volatile *next = &l_timeBase[(seq + 1U) & 1U];
+    uint32_t const ticks = (uint32_t)stepped + (seq - l_sleepSeq);
+
+    next->base = l_sleepBase
+        + ((FreeAct_Time)ticks * (FreeAct_timeFreq() / configTICK_RATE_HZ));
+#if defined(FREEACT_TIME_DWT) && !defined(configSYSTICK_CLOCK_HZ)
+    /* the cycle count at the current tick boundary (SysTick clocked
+    * from the CPU, as set by the FreeRTOS port by default)
+    */
+    next->stamp = DWT_CYCCNT - (SYST_RVR - SYST_CVR);
+#elif defined(FREEACT_TIME_DWT)
+    next->stamp = DWT_CYCCNT; /* the part of the current tick is lost */
+#endif
+    portMEMORY_BARRIER();
+    l_timeSeq = seq + 1U; /* publish the new copy */
+}
+#endif
+/*..........................................................................*/
+FreeAct_Time FreeAct_now(void) {
+    uint32_t seq;
+    FreeAct_Time base;
+    uint32_t stamp;
+
+    do { /* copy the current time base, retry if the tick updated it */
+        seq   = l_timeSeq;
+        base  = l_timeBase[seq & 1U].base;
+        stamp = l_timeBase[seq & 1U].stamp;
+    } while (seq != l_timeSeq);
+
+#ifdef FREEACT_TIME_DWT
+    return base + (uint32_t)(DWT_CYCCNT - stamp);
+#else
+    {
+        /* SysTick counts down from SYST_RVR. If the tick is already
+        * pending (not accounted for in 'base' yet), re-read the counter
+        * after the reload and add the full period.
+        * NOTE: callers preempting the SysTick handler itself (after the
+        * pending bit is cleared, but before the tick hook has run) can
+        * observe time one tick behind.
+        */
+        uint32_t elapsed = SYST_RVR - SYST_CVR;
+        (void)stamp;
+        if ((SCB_ICSR & ICSR_PENDSTSET) != 0U) {
+            elapsed = (SYST_RVR + 1U) + (SYST_RVR - SYST_CVR);
+        }
+        return base + elapsed;
+    }
+#endif
+}
+/*..........................................................................*/
+uint32_t FreeAct_timeFreq(void) {
+#if !defined(FREEACT_TIME_DWT) && defined(configSYSTICK_CLOCK_HZ)
+    return configSYSTICK_CLOCK_HZ; /* SysTick counts */
+#else
+    return configCPU_CLOCK_HZ; /* CPU cycles */
+#endif
+}
+
+#endif /* Cortex-M target */
+
+/*--------------------------------------------------------------------------*/
+/* Critical-section profiler... */
+#if (FREEACT_CS_PROF != 0)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FREEACT_CS_CALLER() ((void const *)__builtin_return_address(0))
+#else
+#define FREEACT_CS_CALLER() ((void const *)0) /* all sites in one bin */
+#endif
+
+FreeAct_CsSite FreeAct_csSite[FREEACT_CS_SITES];
+uint32_t FreeAct_csMax;
+void const *FreeAct_csMaxSite;
+uint32_t FreeAct_csLost;
+
+/* the outermost section being measured (accessed only while masked) */
+static uint32_t l_csNest;
+static void const *l_csSite;
+static FreeAct_Time l_csStart;
+
+static void FreeAct_csBegin(void const *site);
+static void FreeAct_csEnd(void);
+
+/*..........................................................................*/
+/* entered a critical section (interrupts masked already) */
+static void FreeAct_csBegin(void const *site) {
+    if (l_csNest++ == 0U) { /* outermost? */
+        l_csSite  = site;
+        l_csStart = FreeAct_now();
+    }
+}
+/*..........................................................................*/
+/* leaving a critical section (interrupts still masked) */
+static void FreeAct_csEnd(void) {
+    FreeAct_Time dt;
+    uint32_t d;
+    uint32_t h;
+    uint32_t i;
+    uint32_t bin;
+
+    if (--l_csNest != 0U) { /* nested? */
+        return;
+    }
+    dt = FreeAct_now() - l_csStart;
+    d = (dt < 0xFFFFFFFFU) ? (uint32_t)dt : 0xFFFFFFFFU;
+
+    if (d > FreeAct_csMax) {
+        FreeAct_csMax = d;
+        FreeAct_csMaxSite = l_csSite;
+    }
+    bin = 0U; /* floor(log2(d)), clamped to the last bin */
+    for (h = (d >> 1); (h != 0U) && (bin < (FREEACT_CS_BINS - 1U)); h >>= 1) {
+        ++bin;
+    }
+
+    /* open-addressing lookup of the call site */
+    h = (uint32_t)(((uintptr_t)l_csSite >> 1) % FREEACT_CS_SITES);
+    for (i = 0U; i < FREEACT_CS_SITES; ++i) {
+        FreeAct_CsSite * const s = &FreeAct_csSite[h];
+        if ((s->count == 0U) || (s->site == l_csSite)) {
+            s->site = l_csSite;
+            ++s->count;
+            if (d > s->max) {
+                s->max = d;
+            }
+            ++s->hist[bin];
+            return;
+        }
+        if (++h == FREEACT_CS_SITES) {
+            h = 0U;
+        }
+    }
+    ++FreeAct_csLost; /* the table is full */
+}
+/*..........................................................................*/
+void FreeAct_csReset(void) {
+    uint32_t i;
+    uint32_t k;
+
+    taskENTER_CRITICAL();
+    for (i = 0U; i < FREEACT_CS_SITES; ++i) {
+        FreeAct_csSite[i].site  = (void const *)0;
+        FreeAct_csSite[i].count = 0U;
+        FreeAct_csSite[i].max   = 0U;
+        for (k = 0U; k < FREEACT_CS_BINS; ++k) {
+            FreeAct_csSite[i].hist[k] = 0U;
+        }
+    }
+    FreeAct_csMax     = 0U;
+    FreeAct_csMaxSite = (void const *)0;
+    FreeAct_csLost    = 0U;
+    taskEXIT_CRITICAL();
+}
+/*..........................................................................*/
+UBaseType_t FreeAct_csEnterFromISR(void) {
+    UBaseType_t const saved = portSET_INTERRUPT_MASK_FROM_ISR();
+    FreeAct_csBegin(FREEACT_CS_CALLER());
+    return saved;
+}
+/*..........................................................................*/
+void FreeAct_csExitFromISR(UBaseType_t saved) {
+    FreeAct_csEnd();
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(saved);
+}
+
+/*..........................................................................*/
+/* the port's task-level critical section, intercepted at link time */
+#if defined(__ARMCC_VERSION) /* armlink: $Sub$$/$Super$$ patching */
+
+void $Super$$vPortEnterCritical(void);
+void $Super$$vPortExitCritical(void);
+void $Sub$$vPortEnterCritical(void);
+void $Sub$$vPortExitCritical(void);
+
+void $Sub$$vPortEnterCritical(void) {
+    $Super$$vPortEnterCritical();
+    FreeAct_csBegin(FREEACT_CS_CALLER());
+}
+void $Sub$$vPortExitCritical(void) {
+    FreeAct_csEnd();
+    $Super$$vPortExitCritical();
+}
+
+#else /* GNU ld: -Wl,--wrap=vPortEnterCritical,--wrap=vPortExitCritical */
+
+void __real_vPortEnterCritical(void);
+void __real_vPortExitCritical(void);
+void __wrap_vPortEnterCritical(void);
+void __wrap_vPortExitCritical(void);
+
+void __wrap_vPortEnterCritical(void) {
+    __real_vPortEnterCritical();
+    FreeAct_csBegin(FREEACT_CS_CALLER());
+}
+void __wrap_vPortExitCritical(void) {
+    FreeAct_csEnd();
+    __real_vPortExitCritical();
+}
+
+#endif
+
+#endif /* FREEACT_CS_PROF */
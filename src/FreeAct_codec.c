@@ -0,0 +1,90 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Compact binary event codecs
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "FreeAct_codec.h" /* Free Active Object event codecs */
+
+/*..........................................................................*/
+uint8_t *FreeAct_putVarint(uint8_t *p, uint8_t const *end, uint32_t v) {
+    if (p == (uint8_t *)0) {
+        return p;
+    }
+    while (v >= 0x80U) {
+        if (p == end) {
+            return (uint8_t *)0;
+        }
+        *p++ = (uint8_t)(v | 0x80U);
+        v >>= 7;
+    }
+    if (p == end) {
+        return (uint8_t *)0;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+/*..........................................................................*/
+uint8_t const *FreeAct_getVarint(uint8_t const *p, uint8_t const *end,
+                                 uint32_t *v)
+{
+    uint32_t x = 0U;
+    uint8_t shift;
+
+    *v = 0U;
+    if (p == (uint8_t const *)0) {
+        return p;
+    }
+    for (shift = 0U; shift < 35U; shift += 7U) {
+        uint8_t b;
+        if (p == end) {
+            return (uint8_t const *)0; /* truncated */
+        }
+        b = *p++;
+        if ((shift == 28U) && ((b & 0x70U) != 0U)) {
+            return (uint8_t const *)0; /* does not fit in 32 bits */
+        }
+        x |= (uint32_t)(b & 0x7FU) << shift;
+        if ((b & 0x80U) == 0U) {
+            *v = x;
+            return p;
+        }
+    }
+    return (uint8_t const *)0; /* longer than a 32-bit varint */
+}
+/*..........................................................................*/
+uint32_t FreeAct_zigzag(int32_t x) {
+    return ((uint32_t)x << 1) ^ (uint32_t)(-(int32_t)((uint32_t)x >> 31));
+}
+/*..........................................................................*/
+int32_t FreeAct_unzigzag(uint32_t v) {
+    return (int32_t)((v >> 1) ^ (uint32_t)(-(int32_t)(v & 1U)));
+}
@@ -0,0 +1,213 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Lightweight (stackless) Active Objects on FreeRTOS co-routines
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "FreeAct_cr.h" /* Free Active Object co-routine interface */
+
+#if (configUSE_CO_ROUTINES != 0)
+
+static ActiveCR *l_activeCR[FREEACT_MAX_ACTIVE_CR]; /* by co-routine index */
+static uint8_t l_nActiveCR;     /* number of started lightweight AOs */
+static TaskHandle_t l_crTask;   /* dedicated co-routine task (if any) */
+
+/*..........................................................................*/
+void ActiveCR_ctor(ActiveCR * const me, DispatchHandlerCR dispatch) {
+    me->dispatch = dispatch; /* assign the dispatch handler */
+}
+
+/*..........................................................................*/
+/* co-routine function for all lightweight Active Objects
+* NOTE: co-routine locals don't survive blocking, so 'me' is looked up
+* on every entry and the received event is kept in me->evt
+*/
+static void ActiveCR_eventLoop(CoRoutineHandle_t xHandle,
+                               UBaseType_t uxIndex)
+{
+    static Event const initEvt = { INIT_SIG };
+    ActiveCR * const me = l_activeCR[uxIndex];
+    BaseType_t result;
+
+    crSTART(xHandle);
+
+    /* initialize the AO */
+    (*me->dispatch)(me, &initEvt);
+
+    for (;;) {   /* for-ever "superloop" */
+        /* wait for any event and receive it into me->evt */
+        crQUEUE_RECEIVE(xHandle, ActiveCR_queue(me), &me->evt,
+                        portMAX_DELAY, &result); /* BLOCKING! */
+        if (result == pdPASS) {
+            FREEACT_ASSERT_DBG(me->evt != (Event const *)0);
+
+            /* dispatch event to the active object 'me' */
+            (*me->dispatch)(me, me->evt); /* NO BLOCKING! */
+        }
+    }
+
+    crEND();
+}
+
+/*..........................................................................*/
+void ActiveCR_start(ActiveCR * const me,
+                    uint8_t prio,       /* co-routine priority (0-based) */
+                    Event **queueSto,
+                    uint32_t queueLen)
+{
+    QueueHandle_t queue;
+    BaseType_t status;
+
+    FREEACT_ASSERT(l_nActiveCR < FREEACT_MAX_ACTIVE_CR); /* must fit */
+    FREEACT_ASSERT(prio < configMAX_CO_ROUTINE_PRIORITIES);
+
+    queue = xQueueCreateStatic(
+                   queueLen,            /* queue length - provided by user */
+                   sizeof(Event *),     /* item size */
+                   (uint8_t *)queueSto, /* queue storage - provided by user */
+                   &me->queue_cb);      /* queue control block */
+    /* queue must be created and its handle must be the control block */
+    FREEACT_ASSERT(queue == ActiveCR_queue(me));
+    (void)queue;
+
+    l_activeCR[l_nActiveCR] = me;
+    status = xCoRoutineCreate(&ActiveCR_eventLoop, prio, l_nActiveCR);
+    FREEACT_ASSERT(status == pdPASS); /* co-routine must be created (heap) */
+    (void)status;
+    ++l_nActiveCR;
+
+    /* the new co-routine is ready (to initialize the AO), so it needs its
+    * own run of the scheduler, see FreeAct_crLoop()
+    */
+    if (l_crTask != (TaskHandle_t)0) { /* dedicated co-routine task? */
+        xTaskNotifyGive(l_crTask);
+    }
+}
+
+/*..........................................................................*/
+void ActiveCR_post(ActiveCR * const me, Event const * const e) {
+    /* The co-routine queues cannot be used from tasks directly. A task in
+    * a critical section is equivalent to an ISR for the co-routine
+    * scheduler, so the FromISR variant is used here.
+    */
+    taskENTER_CRITICAL();
+    FREEACT_ASSERT(xQueueIsQueueFullFromISR(ActiveCR_queue(me)) == pdFALSE);
+    (void)xQueueCRSendFromISR(ActiveCR_queue(me), &e, pdFALSE);
+    taskEXIT_CRITICAL();
+
+    if (l_crTask != (TaskHandle_t)0) { /* dedicated co-routine task? */
+        xTaskNotifyGive(l_crTask);
+    }
+}
+
+/*..........................................................................*/
+void ActiveCR_postFromISR(ActiveCR * const me, Event const * const e,
+                          BaseType_t *pxHigherPriorityTaskWoken)
+{
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+    FREEACT_ASSERT(xQueueIsQueueFullFromISR(ActiveCR_queue(me)) == pdFALSE);
+    (void)xQueueCRSendFromISR(ActiveCR_queue(me), &e, pdFALSE);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    if (l_crTask != (TaskHandle_t)0) { /* dedicated co-routine task? */
+        vTaskNotifyGiveFromISR(l_crTask, pxHigherPriorityTaskWoken);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+/* Time Event services for lightweight AOs... */
+
+/*..........................................................................*/
+static void TimeEvent_callbackCR(TimerHandle_t xTimer) {
+    /* the timer handle is the address of TimeEvent.timer_cb */
+    TimeEvent * const t = (TimeEvent *)((uintptr_t)xTimer
+                                        - offsetof(TimeEvent, timer_cb));
+
+    if (TimeEvent_expire(t) == pdTRUE) {
+        ActiveCR_post((ActiveCR *)pvTimerGetTimerID(xTimer), &t->super);
+    }
+}
+
+/*..........................................................................*/
+void TimeEvent_ctorCR(TimeEvent * const me, Signal sig, ActiveCR *act) {
+    /* the lightweight AO is the timer ID */
+    TimeEvent_init(me, sig, act, &TimeEvent_callbackCR);
+}
+
+/*--------------------------------------------------------------------------*/
+/* Co-routine scheduling... */
+
+/*..........................................................................*/
+void FreeAct_crSchedule(void) {
+    vCoRoutineSchedule(); /* runs the highest-priority ready co-routine */
+}
+
+/*..........................................................................*/
+/* thread function of the dedicated co-routine task */
+static void FreeAct_crLoop(void *pvParameters) {
+    (void)pvParameters;
+
+    for (;;) {
+        /* Every post and every created co-routine notifies this task
+        * once and readies at most one co-routine, which then processes
+        * all its queued events. vCoRoutineSchedule() runs only one ready
+        * co-routine, so the notifications are counted (not cleared).
+        */
+        (void)ulTaskNotifyTake(pdFALSE, portMAX_DELAY); /* BLOCKING! */
+        vCoRoutineSchedule();
+    }
+}
+
+/*..........................................................................*/
+void FreeAct_crStartTask(uint8_t prio, /* priority (1-based) */
+                         void *stackSto,
+                         uint32_t stackSize)
+{
+    static StaticTask_t crTask_cb; /* co-routine task control-block */
+    uint8_t i;
+
+    l_crTask = xTaskCreateStatic(
+              &FreeAct_crLoop,          /* the thread function */
+              "CR" ,                    /* the name of the task */
+              stackSize / sizeof(StackType_t), /* stack depth */
+              (void *)0,                /* the 'pvParameters' parameter */
+              prio + tskIDLE_PRIORITY,  /* FreeRTOS priority */
+              (StackType_t *)stackSto,  /* stack storage - provided by user */
+              &crTask_cb);              /* task control block */
+    FREEACT_ASSERT(l_crTask != (TaskHandle_t)0); /* task must be created */
+
+    /* the co-routines created so far are all ready to initialize */
+    for (i = 0U; i < l_nActiveCR; ++i) {
+        xTaskNotifyGive(l_crTask);
+    }
+}
+
+#endif /* configUSE_CO_ROUTINES */
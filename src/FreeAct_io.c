@@ -0,0 +1,691 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* I/O services for Active Objects
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#if defined(__unix__) || defined(__APPLE__) /* POSIX host? */
+#define _GNU_SOURCE /* for the timerfd stand-in of the HrTimeEvents */
+#endif
+
+#include "FreeAct_io.h" /* Free Active Object I/O services */
+
+/* compiler barrier ordering the ring accesses in the lock-free channel
+* (single core: the CPU observes its own program order). Other compilers
+* must provide FREEACT_BARRIER() in FreeActConfig.h.
+*/
+#ifndef FREEACT_BARRIER
+#if defined(__GNUC__) || defined(__clang__) /* GCC, clang, ARM Compiler 6 */
+#define FREEACT_BARRIER() __asm volatile ("" ::: "memory")
+#elif defined(__CC_ARM) /* ARM Compiler 5 */
+#define FREEACT_BARRIER() __memory_changed()
+#else
+#error "FREEACT_BARRIER() not defined for this compiler"
+#endif
+#endif
+
+/*--------------------------------------------------------------------------*/
+/* Debouncer services... */
+
+/*..........................................................................*/
+void Debouncer_ctor(Debouncer * const me, Signal sig, Active *ao,
+                    uint32_t *sto,   /* DEBOUNCER_STO_SIZE() words */
+                    uint8_t nPorts,
+                    uint8_t samples)
+{
+    uint16_t i;
+
+    FREEACT_ASSERT((nPorts > 0U) && (samples >= 2U) && (samples <= 8U));
+
+    me->super.sig = sig;
+    me->ao        = ao;
+    me->history   = &sto[0];
+    me->stable    = &sto[nPorts * (samples - 1U)];
+    me->changed   = &sto[nPorts * samples];
+    me->nPorts    = nPorts;
+    me->samples   = samples;
+    me->idx       = 0U;
+    me->pending   = 0U;
+    me->edge      = 0U;
+    for (i = 0U; i < DEBOUNCER_STO_SIZE(nPorts, samples); ++i) {
+        sto[i] = 0U; /* all inputs inactive */
+    }
+}
+/*..........................................................................*/
+void Debouncer_tickFromISR(Debouncer * const me, uint32_t const *ports,
+                           BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint8_t const depth = (uint8_t)(me->samples - 1U);
+    uint32_t *hist = me->history;
+    uint32_t any = 0U;
+    uint8_t p;
+
+    me->edge = 0U; /* the edge (if any) is in this sample */
+    for (p = 0U; p < me->nPorts; ++p, hist += depth) {
+        uint32_t const current = ports[p];
+        uint32_t allOn  = current; /* active in all samples */
+        uint32_t anyOn  = current; /* active in any sample */
+        uint32_t stable = me->stable[p];
+        uint32_t tmp;
+        uint8_t k;
+
+        for (k = 0U; k < depth; ++k) {
+            allOn &= hist[k];
+            anyOn |= hist[k];
+        }
+        hist[me->idx] = current;   /* replace the oldest sample */
+
+        tmp = stable;
+        stable |= allOn;           /* set depressed */
+        stable &= anyOn;           /* clear released */
+        tmp ^= stable;             /* changed debounced state */
+        me->stable[p]   = stable;
+        me->changed[p] ^= tmp;     /* net change since the last read */
+        any |= tmp;
+    }
+    if (++me->idx == depth) {
+        me->idx = 0U;
+    }
+
+    if ((any != 0U) && (me->pending == 0U)) { /* new change-set? */
+        me->pending = 1U;
+        Active_postFromISR(me->ao, &me->super, pxHigherPriorityTaskWoken);
+    }
+}
+/*..........................................................................*/
+void Debouncer_read(Event const * const e,
+                    uint32_t *changed, uint32_t *state)
+{
+    Debouncer * const me = (Debouncer *)e;
+    uint8_t p;
+
+    taskENTER_CRITICAL();
+    for (p = 0U; p < me->nPorts; ++p) {
+        changed[p] = me->changed[p];
+        me->changed[p] = 0U;
+        state[p] = me->stable[p];
+    }
+    me->pending = 0U;
+    taskEXIT_CRITICAL();
+}
+/*..........................................................................*/
+BaseType_t Debouncer_isSettled(Debouncer * const me) {
+    uint8_t const depth = (uint8_t)(me->samples - 1U);
+    BaseType_t settled;
+    uint8_t p;
+    uint8_t k;
+
+    taskENTER_CRITICAL();
+    settled = (me->edge == 0U) ? pdTRUE : pdFALSE;
+    for (p = 0U; (p < me->nPorts) && (settled == pdTRUE); ++p) {
+        uint32_t const *hist = &me->history[p * depth];
+        for (k = 0U; k < depth; ++k) {
+            if (hist[k] != me->stable[p]) { /* change in progress? */
+                settled = pdFALSE;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+    return settled;
+}
+/*..........................................................................*/
+void Debouncer_edgeFromISR(Debouncer * const me) {
+    me->edge = 1U; /* not settled until the next tick samples the inputs */
+}
+
+/*--------------------------------------------------------------------------*/
+/* Zero-latency ISR channel services... */
+
+#if defined(__unix__) || defined(__APPLE__) /* POSIX host (multi-core)? */
+#ifdef FREEACT_SWI_IRQ
+#error "FREEACT_SWI_IRQ is a Cortex-M NVIC interrupt, not for a POSIX host"
+#endif
+/* a native thread posts on another core: acquire/release ordering */
+#define ISR_CHAN_LOAD(p_)      __atomic_load_n((p_), __ATOMIC_ACQUIRE)
+#define ISR_CHAN_STORE(p_, v_) __atomic_store_n((p_), (v_), __ATOMIC_RELEASE)
+#else
+static uint16_t IsrChannel_load(uint16_t volatile const *p);
+static void IsrChannel_store(uint16_t volatile *p, uint16_t v);
+#define ISR_CHAN_LOAD(p_)      IsrChannel_load(p_)
+#define ISR_CHAN_STORE(p_, v_) IsrChannel_store((p_), (v_))
+
+/*..........................................................................*/
+/* index of the other side, the ring accesses that follow stay after it */
+static uint16_t IsrChannel_load(uint16_t volatile const *p) {
+    uint16_t const v = *p;
+    FREEACT_BARRIER();
+    return v;
+}
+/*..........................................................................*/
+/* publish an index, the ring accesses that precede stay before it */
+static void IsrChannel_store(uint16_t volatile *p, uint16_t v) {
+    FREEACT_BARRIER();
+    *p = v;
+}
+#endif
+
+static IsrChannel *l_isrChannels; /* registered channels */
+
+/*..........................................................................*/
+void IsrChannel_ctor(IsrChannel * const me, IsrPost *bufSto, uint16_t len) {
+    FREEACT_ASSERT(len > 1U);
+
+    me->buf  = bufSto;
+    me->len  = len;
+    me->head = 0U;
+    me->tail = 0U;
+    me->lost = 0U;
+
+    taskENTER_CRITICAL();
+    me->next = l_isrChannels;
+    l_isrChannels = me;
+    taskEXIT_CRITICAL();
+}
+/*..........................................................................*/
+BaseType_t IsrChannel_post(IsrChannel * const me, Active *ao,
+                           Event const * const e)
+{
+    uint16_t const head = me->head;
+    uint16_t next = (uint16_t)(head + 1U);
+
+    if (next == me->len) {
+        next = 0U;
+    }
+    if (next == ISR_CHAN_LOAD(&me->tail)) { /* ring full? */
+        ++me->lost;
+        return pdFALSE;
+    }
+    me->buf[head].ao = ao;
+    me->buf[head].e  = e;
+    ISR_CHAN_STORE(&me->head, next); /* publish the written slot */
+
+    FREEACT_SWI_PEND(); /* forward at the kernel-aware priority */
+    return pdTRUE;
+}
+/*..........................................................................*/
+void IsrChannel_forwardFromISR(BaseType_t *pxHigherPriorityTaskWoken) {
+    IsrChannel *ch;
+
+    for (ch = l_isrChannels; ch != (IsrChannel *)0; ch = ch->next) {
+        uint16_t tail = ch->tail;
+        while (tail != ISR_CHAN_LOAD(&ch->head)) { /* slot published? */
+            Active_postFromISR(ch->buf[tail].ao, ch->buf[tail].e,
+                               pxHigherPriorityTaskWoken);
+            if (++tail == ch->len) {
+                tail = 0U;
+            }
+            ISR_CHAN_STORE(&ch->tail, tail); /* free the slot */
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+/* Coalescing channel services... */
+
+static void Coalescer_swap(Coalescer * const me);
+
+/*..........................................................................*/
+void Coalescer_ctor(Coalescer * const me, Signal sig, Active *ao,
+                    uint32_t *sto,  /* storage for 2*cap samples */
+                    uint16_t cap,
+                    uint16_t threshold,
+                    uint32_t timeoutMs)
+{
+    FREEACT_ASSERT((threshold > 0U) && (threshold <= cap));
+
+    me->super.sig = sig;
+    TimeEvent_ctor(&me->timeout, sig, ao);
+    me->ao        = ao;
+    me->block[0]  = &sto[0];
+    me->block[1]  = &sto[cap];
+    me->count[0]  = 0U;
+    me->count[1]  = 0U;
+    me->start[0]  = 0U;
+    me->start[1]  = 0U;
+    me->cap       = cap;
+    me->threshold = threshold;
+    me->timeoutMs = timeoutMs;
+    me->fill      = 0U;
+    me->busy      = 0U;
+    me->lost      = 0U;
+}
+/*..........................................................................*/
+void Coalescer_setThreshold(Coalescer * const me, uint16_t threshold) {
+    FREEACT_ASSERT((threshold > 0U) && (threshold <= me->cap));
+    me->threshold = threshold; /* takes effect with the next sample */
+}
+/*..........................................................................*/
+void Coalescer_setTimeout(Coalescer * const me, uint32_t timeoutMs) {
+    me->timeoutMs = timeoutMs; /* takes effect with the next block */
+}
+/*..........................................................................*/
+/* hand over the block being filled to the AO (in a critical section) */
+static void Coalescer_swap(Coalescer * const me) {
+    uint8_t const fill = (uint8_t)(me->fill ^ 1U);
+    me->count[fill] = 0U;
+    me->fill = fill;
+    me->busy = 1U;
+}
+/*..........................................................................*/
+void Coalescer_appendFromISR(Coalescer * const me, uint32_t sample,
+                             BaseType_t *pxHigherPriorityTaskWoken)
+{
+    uint8_t const fill = me->fill;
+    uint16_t n = me->count[fill];
+
+    if (n == me->cap) { /* no room? */
+        ++me->lost;
+        return;
+    }
+    me->block[fill][n] = sample;
+    me->count[fill] = ++n;
+
+    if (n == 1U) { /* first sample of the block? */
+        me->start[fill] = xTaskGetTickCountFromISR();
+        if (me->timeoutMs != 0U) {
+            TimeEvent_armFromISR(&me->timeout, me->timeoutMs,
+                                 pxHigherPriorityTaskWoken);
+        }
+    }
+    if ((n >= me->threshold) && (me->busy == 0U)) {
+        Coalescer_swap(me);
+        if (me->timeoutMs != 0U) {
+            TimeEvent_disarmFromISR(&me->timeout, pxHigherPriorityTaskWoken);
+        }
+        Active_postFromISR(me->ao, &me->super, pxHigherPriorityTaskWoken);
+    }
+}
+/*..........................................................................*/
+uint16_t Coalescer_take(Coalescer * const me, Event const * const e,
+                        uint32_t const **samples)
+{
+    uint16_t n;
+    uint8_t ready;
+
+    taskENTER_CRITICAL();
+    if (e == &me->timeout.super) { /* timeout? */
+        uint8_t const fill = me->fill;
+        /* flush only a block that is really due, because the timeout
+        * can be stale (e.g., it expired while the block was posted)
+        */
+        if ((me->busy == 0U) && (me->count[fill] != 0U)
+            && ((TickType_t)(xTaskGetTickCount() - me->start[fill])
+                >= FreeAct_msToTicks(me->timeoutMs)))
+        {
+            Coalescer_swap(me);
+        }
+        else {
+            taskEXIT_CRITICAL();
+            *samples = me->block[0];
+            return 0U; /* nothing to take */
+        }
+    }
+    ready = (uint8_t)(me->fill ^ 1U);
+    n = me->count[ready];
+    taskEXIT_CRITICAL();
+
+    *samples = me->block[ready];
+    return n;
+}
+/*..........................................................................*/
+void Coalescer_release(Coalescer * const me) {
+    BaseType_t post = pdFALSE;
+    TickType_t left = 0U; /* ticks to the timeout of the block being filled */
+
+    taskENTER_CRITICAL();
+    me->busy = 0U;
+    if (me->count[me->fill] >= me->threshold) { /* filled meanwhile? */
+        Coalescer_swap(me);
+        post = pdTRUE;
+    }
+    else if ((me->count[me->fill] != 0U) && (me->timeoutMs != 0U)) {
+        /* the timeout might have expired while the AO held the other
+        * block, and then Coalescer_take() dropped it
+        */
+        TickType_t const age = xTaskGetTickCount() - me->start[me->fill];
+        TickType_t const tmo = FreeAct_msToTicks(me->timeoutMs);
+        if (age >= tmo) { /* due already? */
+            Coalescer_swap(me);
+            post = pdTRUE;
+        }
+        else {
+            left = tmo - age;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    /* NOTE: the timeout of the posted block is not disarmed here, because
+    * the ISR might have armed it already for the next block. A stale
+    * timeout is filtered out in Coalescer_take().
+    */
+    if (post == pdTRUE) {
+        Active_post(me->ao, &me->super);
+    }
+    else if (left != 0U) { /* re-arm for the rest of the block timeout */
+        TimeEvent_armX(&me->timeout, left, 0U);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+/* High-resolution Time Event services... */
+#if (FREEACT_HR_TIMER != 0)
+
+#if defined(__unix__) || defined(__APPLE__) /* POSIX host? */
+
+/* the compare ISR is a timerfd thread, the timerfd is Linux-only */
+#if !defined(__linux__)
+#error "the HrTimeEvent host stand-in needs Linux (timerfd)"
+#endif
+
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+static pthread_mutex_t l_hrMutex = PTHREAD_MUTEX_INITIALIZER;
+static IsrChannel l_hrChan; /* the thread posts like a zero-latency ISR */
+static int l_hrFd = -1;
+
+/* NOTE: the tasks hold the mutex in a critical section, so that the
+* FreeRTOS POSIX port cannot switch them out with the mutex locked (the
+* task switched in would block its thread on the mutex for good). The
+* timerfd thread is not a task and takes only the mutex.
+*/
+#define HR_CRIT_STAT
+#define HR_CRIT_ENTRY() do { \
+    taskENTER_CRITICAL(); \
+    (void)pthread_mutex_lock(&l_hrMutex); \
+} while (0)
+#define HR_CRIT_EXIT() do { \
+    (void)pthread_mutex_unlock(&l_hrMutex); \
+    taskEXIT_CRITICAL(); \
+} while (0)
+#define HR_CRIT_ENTRY_ISR() ((void)pthread_mutex_lock(&l_hrMutex))
+#define HR_CRIT_EXIT_ISR()  ((void)pthread_mutex_unlock(&l_hrMutex))
+#define HR_POST(ao_, e_, pxWoken_) \
+    ((void)(pxWoken_), (void)IsrChannel_post(&l_hrChan, (ao_), (e_)))
+
+#else /* kernel-aware compare ISR */
+
+#define HR_CRIT_STAT        UBaseType_t hrSaved_;
+#define HR_CRIT_ENTRY()     taskENTER_CRITICAL()
+#define HR_CRIT_EXIT()      taskEXIT_CRITICAL()
+#define HR_CRIT_ENTRY_ISR() (hrSaved_ = taskENTER_CRITICAL_FROM_ISR())
+#define HR_CRIT_EXIT_ISR()  taskEXIT_CRITICAL_FROM_ISR(hrSaved_)
+#define HR_POST(ao_, e_, pxWoken_) \
+    Active_postFromISR((ao_), (e_), (pxWoken_))
+
+#endif
+
+static HrTimeEvent *l_hrArmed; /* armed HrTimeEvents, nearest first */
+
+static uint32_t HrTimeEvent_counts(uint32_t us, uint32_t *frac);
+static void HrTimeEvent_insert(HrTimeEvent * const me);
+static void HrTimeEvent_set(HrTimeEvent * const me,
+                            uint32_t firstUs, uint32_t intervalUs);
+static void HrTimeEvent_clear(HrTimeEvent * const me);
+
+/*..........................................................................*/
+void HrTimeEvent_ctor(HrTimeEvent * const me, Signal sig, Active *ao) {
+    me->super.sig = sig;
+    me->ao       = ao;
+    me->next     = (HrTimeEvent *)0;
+    me->deadline = 0U;
+    me->interval = 0U;
+    me->frac     = 0U;
+    me->acc      = 0U;
+    me->armed    = 0U;
+}
+/*..........................................................................*/
+/* microseconds in counter counts, the remainder in 1e-6 count */
+static uint32_t HrTimeEvent_counts(uint32_t us, uint32_t *frac) {
+    uint64_t const n = (uint64_t)us * FreeAct_hrFreq();
+    FREEACT_ASSERT((n / 1000000U) < 0x80000000U); /* wrap-safe compares */
+    *frac = (uint32_t)(n % 1000000U);
+    return (uint32_t)(n / 1000000U);
+}
+/*..........................................................................*/
+/* insert into the armed list after the equal deadlines (in a crit. sect.) */
+static void HrTimeEvent_insert(HrTimeEvent * const me) {
+    HrTimeEvent **pp = &l_hrArmed;
+    while ((*pp != (HrTimeEvent *)0)
+           && ((int32_t)((*pp)->deadline - me->deadline) <= 0))
+    {
+        pp = &(*pp)->next;
+    }
+    me->next = *pp;
+    *pp = me;
+}
+/*..........................................................................*/
+/* remove from the armed list (in a critical section) */
+static void HrTimeEvent_clear(HrTimeEvent * const me) {
+    if (me->armed != 0U) {
+        HrTimeEvent **pp = &l_hrArmed;
+        while (*pp != me) {
+            pp = &(*pp)->next;
+        }
+        *pp = me->next;
+        me->armed = 0U;
+        if (pp == &l_hrArmed) { /* was the nearest deadline? */
+            if (l_hrArmed != (HrTimeEvent *)0) {
+                FreeAct_hrSetCompare(l_hrArmed->deadline);
+            }
+            else {
+                FreeAct_hrStop();
+            }
+        }
+    }
+}
+/*..........................................................................*/
+/* (re)arm (in a critical section) */
+static void HrTimeEvent_set(HrTimeEvent * const me,
+                            uint32_t firstUs, uint32_t intervalUs)
+{
+    uint32_t frac;
+    uint32_t first = HrTimeEvent_counts(firstUs, &frac);
+
+    me->interval = HrTimeEvent_counts(intervalUs, &frac);
+    FREEACT_ASSERT((intervalUs == 0U) || (me->interval > 0U));
+    if (first == 0U) {
+        first = 1U;
+    }
+    HrTimeEvent_clear(me);
+    me->deadline = FreeAct_hrNow() + first;
+    me->frac     = frac;
+    me->acc      = 0U;
+    me->armed    = 1U;
+    HrTimeEvent_insert(me);
+    if (l_hrArmed == me) { /* the new nearest deadline? */
+        FreeAct_hrSetCompare(me->deadline);
+    }
+}
+/*..........................................................................*/
+void HrTimeEvent_arm(HrTimeEvent * const me,
+                     uint32_t firstUs, uint32_t intervalUs)
+{
+    HR_CRIT_ENTRY();
+    HrTimeEvent_set(me, firstUs, intervalUs);
+    HR_CRIT_EXIT();
+}
+/*..........................................................................*/
+void HrTimeEvent_disarm(HrTimeEvent * const me) {
+    HR_CRIT_ENTRY();
+    HrTimeEvent_clear(me);
+    HR_CRIT_EXIT();
+}
+/*..........................................................................*/
+void HrTimeEvent_armFromISR(HrTimeEvent * const me,
+                            uint32_t firstUs, uint32_t intervalUs)
+{
+    HR_CRIT_STAT
+    HR_CRIT_ENTRY_ISR();
+    HrTimeEvent_set(me, firstUs, intervalUs);
+    HR_CRIT_EXIT_ISR();
+}
+/*..........................................................................*/
+void HrTimeEvent_disarmFromISR(HrTimeEvent * const me) {
+    HR_CRIT_STAT
+    HR_CRIT_ENTRY_ISR();
+    HrTimeEvent_clear(me);
+    HR_CRIT_EXIT_ISR();
+}
+/*..........................................................................*/
+void HrTimeEvent_compareFromISR(BaseType_t *pxHigherPriorityTaskWoken) {
+    uint32_t const now = FreeAct_hrNow();
+    HR_CRIT_STAT
+
+    /* take the expired HrTimeEvents one by one, post outside the critical
+    * section, so that the interrupts stay masked only for the list update
+    */
+    for (;;) {
+        HrTimeEvent *t;
+
+        HR_CRIT_ENTRY_ISR();
+        t = l_hrArmed;
+        if ((t != (HrTimeEvent *)0) && ((int32_t)(now - t->deadline) >= 0)) {
+            l_hrArmed = t->next;
+            if (t->interval == 0U) { /* one-shot? */
+                t->armed = 0U;
+            }
+            else {
+                /* the next deadline from the previous one (no drift),
+                * skipping the periods missed already (no burst)
+                */
+                do {
+                    t->deadline += t->interval;
+                    t->acc += t->frac;
+                    if (t->acc >= 1000000U) { /* a whole count? */
+                        t->acc -= 1000000U;
+                        ++t->deadline;
+                    }
+                } while ((int32_t)(now - t->deadline) >= 0);
+                HrTimeEvent_insert(t);
+            }
+        }
+        else { /* nothing (more) expired: program the nearest deadline */
+            t = (HrTimeEvent *)0;
+            if (l_hrArmed != (HrTimeEvent *)0) {
+                FreeAct_hrSetCompare(l_hrArmed->deadline);
+            }
+            else {
+                FreeAct_hrStop();
+            }
+        }
+        HR_CRIT_EXIT_ISR();
+
+        if (t == (HrTimeEvent *)0) {
+            break;
+        }
+        HR_POST(t->ao, &t->super, pxHigherPriorityTaskWoken);
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__) /* POSIX host? */
+/*..........................................................................*/
+static uint64_t FreeAct_hrHostNs(void) {
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+/*..........................................................................*/
+uint32_t FreeAct_hrNow(void) {
+    return (uint32_t)(FreeAct_hrHostNs() / 1000U); /* microseconds */
+}
+/*..........................................................................*/
+uint32_t FreeAct_hrFreq(void) {
+    return 1000000U;
+}
+/*..........................................................................*/
+void FreeAct_hrSetCompare(uint32_t at) {
+    struct itimerspec its;
+    uint64_t const ns = FreeAct_hrHostNs();
+    int32_t const left = (int32_t)(at - (uint32_t)(ns / 1000U));
+    /* a deadline in the past expires right away (1ns from now) */
+    uint64_t const due = ns + ((left > 0) ? ((uint64_t)left * 1000U) : 1U);
+
+    its.it_interval.tv_sec  = 0;
+    its.it_interval.tv_nsec = 0;
+    its.it_value.tv_sec  = (time_t)(due / 1000000000U);
+    its.it_value.tv_nsec = (long)(due % 1000000000U);
+    (void)timerfd_settime(l_hrFd, TFD_TIMER_ABSTIME, &its,
+                          (struct itimerspec *)0);
+}
+/*..........................................................................*/
+void FreeAct_hrStop(void) {
+    struct itimerspec its;
+    its.it_interval.tv_sec  = 0;
+    its.it_interval.tv_nsec = 0;
+    its.it_value.tv_sec  = 0; /* disarm the timerfd */
+    its.it_value.tv_nsec = 0;
+    (void)timerfd_settime(l_hrFd, 0, &its, (struct itimerspec *)0);
+}
+/*..........................................................................*/
+static void *HrTimeEvent_hostLoop(void *arg) {
+    uint64_t n;
+    (void)arg;
+    for (;;) {
+        if (read(l_hrFd, &n, sizeof(n)) == (ssize_t)sizeof(n)) {
+            HrTimeEvent_compareFromISR((BaseType_t *)0);
+        }
+    }
+    return (void *)0;
+}
+/*..........................................................................*/
+BaseType_t HrTimeEvent_hostStart(IsrPost *chanSto, uint16_t chanLen) {
+    pthread_t thread;
+    sigset_t all;
+    sigset_t saved;
+    int err;
+
+    IsrChannel_ctor(&l_hrChan, chanSto, chanLen);
+    l_hrFd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (l_hrFd < 0) {
+        return pdFALSE;
+    }
+
+    /* the thread inherits the signal mask: block all signals in it, so
+    * that the tick signal of the POSIX port always lands in a task
+    */
+    (void)sigfillset(&all);
+    (void)pthread_sigmask(SIG_SETMASK, &all, &saved);
+    err = pthread_create(&thread, (pthread_attr_t *)0,
+                         &HrTimeEvent_hostLoop, (void *)0);
+    (void)pthread_sigmask(SIG_SETMASK, &saved, (sigset_t *)0);
+    if (err != 0) {
+        return pdFALSE;
+    }
+    (void)pthread_detach(thread);
+    return pdTRUE;
+}
+#endif /* POSIX host */
+
+#endif /* FREEACT_HR_TIMER */
@@ -0,0 +1,404 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Remote Active Object proxies over pluggable transports
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "FreeAct_remote.h" /* Free Active Object remote proxies */
+
+#include <string.h> /* for memcpy() */
+
+#define REMOTE_SYNC 0x7EU
+
+/* states of the inbound deframer */
+enum RemoteRxStates {
+    RX_HUNT, RX_LEN0, RX_LEN1, RX_DATA, RX_CRC0, RX_CRC1
+};
+
+static uint16_t Remote_crc16(uint16_t crc, uint8_t const *data, uint32_t len);
+static void RemoteLink_send(RemoteLink * const me);
+static void RemoteLink_append(RemoteLink * const me, uint8_t dst,
+                              Event const * const e, BaseType_t flush);
+static void RemoteLink_deliver(RemoteLink * const me);
+static void RemoteProxy_dispatch(Active * const me, Event const * const e);
+
+/*..........................................................................*/
+/* CRC-16/CCITT (polynomial 0x1021), bitwise to keep the code small */
+static uint16_t Remote_crc16(uint16_t crc, uint8_t const *data, uint32_t len) {
+    for (; len > 0U; --len, ++data) {
+        uint8_t b;
+        crc ^= (uint16_t)((uint16_t)*data << 8);
+        for (b = 0U; b < 8U; ++b) {
+            crc = ((crc & 0x8000U) != 0U)
+                  ? (uint16_t)((crc << 1) ^ 0x1021U)
+                  : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/*--------------------------------------------------------------------------*/
+/* Remote link services... */
+
+/*..........................................................................*/
+void RemoteLink_ctor(RemoteLink * const me, Transport * const transport,
+                     uint8_t const *evtSize, Signal nSigs,
+                     uint8_t *frameSto, uint16_t frameLen,
+                     uint8_t *rxSto, uint16_t rxLen)
+{
+    uint8_t i;
+
+    FREEACT_ASSERT(frameLen > (REMOTE_FRAME_OVERHEAD + 2U));
+
+    me->transport = transport;
+    transport->link = me;
+    me->evtSize   = evtSize;
+    me->nSigs     = nSigs;
+    me->frame     = frameSto;
+    me->frameLen  = frameLen;
+    me->frameUsed = 0U;
+    me->rxBuf     = rxSto;
+    me->rxLen     = rxLen;
+    me->rxUsed    = 0U;
+    me->rxNeed    = 0U;
+    me->rxCrc     = 0U;
+    me->rxState   = RX_HUNT;
+    me->txDropped = 0U;
+    me->rxErrors  = 0U;
+    for (i = 0U; i < FREEACT_REMOTE_MAX_EXPORT; ++i) {
+        me->exports[i].ao = (Active *)0;
+    }
+}
+/*..........................................................................*/
+void RemoteLink_export(RemoteLink * const me, uint8_t id, Active *ao,
+                       RemoteSlot *slotSto, uint8_t nSlots)
+{
+    FREEACT_ASSERT((id < FREEACT_REMOTE_MAX_EXPORT) && (nSlots >= 2U));
+
+    me->exports[id].slots  = slotSto;
+    me->exports[id].nSlots = nSlots;
+    me->exports[id].next   = 0U;
+    me->exports[id].ao     = ao;
+}
+/*..........................................................................*/
+/* frame the batched records and pass them to the transport
+* (called with the scheduler suspended)
+*/
+static void RemoteLink_send(RemoteLink * const me) {
+    uint16_t const used = me->frameUsed;
+    uint16_t crc;
+
+    if (used == 0U) { /* nothing batched? */
+        return;
+    }
+    me->frame[0] = REMOTE_SYNC;
+    me->frame[1] = (uint8_t)used;
+    me->frame[2] = (uint8_t)(used >> 8);
+    crc = Remote_crc16(0xFFFFU, &me->frame[1], used + 2U);
+    me->frame[3U + used] = (uint8_t)crc;
+    me->frame[4U + used] = (uint8_t)(crc >> 8);
+
+    if ((*me->transport->send)(me->transport, me->frame,
+                               (uint16_t)(used + REMOTE_FRAME_OVERHEAD))
+        != pdTRUE)
+    {
+        ++me->txDropped;
+    }
+    me->frameUsed = 0U;
+}
+/*..........................................................................*/
+void RemoteLink_flush(RemoteLink * const me) {
+    vTaskSuspendAll(); /* serialize with the proxies of the link */
+    RemoteLink_send(me);
+    (void)xTaskResumeAll();
+}
+/*..........................................................................*/
+static void RemoteLink_append(RemoteLink * const me, uint8_t dst,
+                              Event const * const e, BaseType_t flush)
+{
+    uint8_t const size = (e->sig < me->nSigs) ? me->evtSize[e->sig] : 0U;
+    uint8_t *rec;
+
+    /* the event must be remotable */
+    FREEACT_ASSERT((size >= sizeof(Event))
+                   && (size <= FREEACT_REMOTE_MAX_EVT)
+                   && ((size + 2U + REMOTE_FRAME_OVERHEAD) <= me->frameLen));
+
+    vTaskSuspendAll(); /* the frame is shared by all proxies of the link */
+    if ((me->frameUsed + size + 2U + REMOTE_FRAME_OVERHEAD) > me->frameLen) {
+        RemoteLink_send(me); /* no room for the record */
+    }
+    rec = &me->frame[3U + me->frameUsed];
+    rec[0] = dst;
+    rec[1] = size;
+    memcpy(&rec[2], e, size);
+    me->frameUsed = (uint16_t)(me->frameUsed + size + 2U);
+    if (flush == pdTRUE) {
+        RemoteLink_send(me);
+    }
+    (void)xTaskResumeAll();
+}
+/*..........................................................................*/
+/* post the events of a complete, valid inbound frame */
+static void RemoteLink_deliver(RemoteLink * const me) {
+    uint8_t const *rec = me->rxBuf;
+    uint8_t const * const end = &me->rxBuf[me->rxUsed];
+
+    while ((end - rec) >= 2) {
+        uint8_t const dst  = rec[0];
+        uint8_t const size = rec[1];
+        RemoteExport *exp;
+        RemoteSlot *slot;
+
+        if ((end - rec) < (2 + size)) { /* truncated record? */
+            ++me->rxErrors;
+            return;
+        }
+        if ((dst >= FREEACT_REMOTE_MAX_EXPORT)
+            || (me->exports[dst].ao == (Active *)0)
+            || (size < sizeof(Event)) || (size > FREEACT_REMOTE_MAX_EVT))
+        {
+            ++me->rxErrors; /* skip the record */
+        }
+        else {
+            exp = &me->exports[dst];
+            slot = &exp->slots[exp->next];
+            if (++exp->next == exp->nSlots) {
+                exp->next = 0U;
+            }
+            memcpy(slot->bytes, &rec[2], size);
+            Active_post(exp->ao, &slot->evt);
+        }
+        rec += 2U + size;
+    }
+}
+/*..........................................................................*/
+void RemoteLink_onRx(RemoteLink * const me,
+                     uint8_t const *data, uint32_t len)
+{
+    for (; len > 0U; --len, ++data) {
+        uint8_t const b = *data;
+        switch (me->rxState) {
+            case RX_HUNT: {
+                if (b == REMOTE_SYNC) {
+                    me->rxState = RX_LEN0;
+                }
+                break;
+            }
+            case RX_LEN0: {
+                me->rxNeed = b;
+                me->rxState = RX_LEN1;
+                break;
+            }
+            case RX_LEN1: {
+                me->rxNeed |= (uint16_t)((uint16_t)b << 8);
+                me->rxUsed = 0U;
+                if ((me->rxNeed == 0U) || (me->rxNeed > me->rxLen)) {
+                    ++me->rxErrors; /* not a valid frame, resynchronize */
+                    me->rxState = RX_HUNT;
+                }
+                else {
+                    me->rxState = RX_DATA;
+                }
+                break;
+            }
+            case RX_DATA: {
+                me->rxBuf[me->rxUsed] = b;
+                if (++me->rxUsed == me->rxNeed) {
+                    me->rxState = RX_CRC0;
+                }
+                break;
+            }
+            case RX_CRC0: {
+                me->rxCrc = b;
+                me->rxState = RX_CRC1;
+                break;
+            }
+            case RX_CRC1: {
+                uint8_t hdr[2];
+                uint16_t crc;
+                me->rxCrc |= (uint16_t)((uint16_t)b << 8);
+                hdr[0] = (uint8_t)me->rxNeed;
+                hdr[1] = (uint8_t)(me->rxNeed >> 8);
+                crc = Remote_crc16(0xFFFFU, hdr, 2U);
+                crc = Remote_crc16(crc, me->rxBuf, me->rxUsed);
+                if (crc == me->rxCrc) {
+                    RemoteLink_deliver(me);
+                }
+                else {
+                    ++me->rxErrors;
+                }
+                me->rxState = RX_HUNT;
+                break;
+            }
+            default: {
+                me->rxState = RX_HUNT;
+                break;
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+/* Remote proxy services... */
+
+/*..........................................................................*/
+void RemoteProxy_ctor(RemoteProxy * const me, RemoteLink *link, uint8_t dst) {
+    Active_ctor(&me->super, &RemoteProxy_dispatch);
+    me->link = link;
+    me->dst  = dst;
+}
+/*..........................................................................*/
+static void RemoteProxy_dispatch(Active * const me, Event const * const e) {
+    RemoteProxy * const proxy = (RemoteProxy *)me;
+
+    if (e->sig == INIT_SIG) { /* the proxy's own initial event */
+        return;
+    }
+    /* batch the events while more are queued, flush on the last one */
+    RemoteLink_append(proxy->link, proxy->dst, e,
+                      (Active_pending(me) == 0U) ? pdTRUE : pdFALSE);
+}
+
+/*--------------------------------------------------------------------------*/
+/* Stream (UART) transport services... */
+
+static BaseType_t StreamTransport_send(Transport * const me,
+                                       uint8_t const *frame, uint16_t len);
+static void StreamTransport_rxThread(void *pvParameters);
+
+/*..........................................................................*/
+void StreamTransport_ctor(StreamTransport * const me,
+                          uint8_t *txSto, uint32_t txLen,
+                          uint8_t *rxSto, uint32_t rxLen,
+                          void (*txKick)(void))
+{
+    StreamBufferHandle_t sb;
+
+    me->super.send = &StreamTransport_send;
+    me->super.link = (RemoteLink *)0; /* set by RemoteLink_ctor() */
+    me->txKick = txKick;
+
+    sb = xStreamBufferCreateStatic(txLen, 1U, txSto, &me->tx_cb);
+    FREEACT_ASSERT(sb == StreamTransport_tx(me));
+    sb = xStreamBufferCreateStatic(rxLen, 1U, rxSto, &me->rx_cb);
+    FREEACT_ASSERT(sb == StreamTransport_rx(me));
+    (void)sb;
+}
+/*..........................................................................*/
+void StreamTransport_startRx(StreamTransport * const me,
+                             uint8_t prio,   /* priority (1-based) */
+                             void *stackSto,
+                             uint32_t stackSize)
+{
+    TaskHandle_t thr;
+
+    FREEACT_ASSERT((prio > 0U) && (me->super.link != (RemoteLink *)0));
+
+    thr = xTaskCreateStatic(
+              &StreamTransport_rxThread, /* the RX thread function */
+              "RX" ,                     /* the name of the task */
+              stackSize/sizeof(portSTACK_TYPE), /* stack length */
+              (void *)me,                /* the 'pvParameters' parameter */
+              prio + tskIDLE_PRIORITY,   /* FreeRTOS priority */
+              (StackType_t *)stackSto,   /* stack storage */
+              &me->thread_cb);           /* task buffer */
+    FREEACT_ASSERT(thr == (TaskHandle_t)&me->thread_cb);
+    (void)thr;
+}
+/*..........................................................................*/
+/* called with the scheduler suspended, so there is a single writer */
+static BaseType_t StreamTransport_send(Transport * const me,
+                                       uint8_t const *frame, uint16_t len)
+{
+    StreamTransport * const st = (StreamTransport *)me;
+
+    /* whole frames only, never block */
+    if (xStreamBufferSpacesAvailable(StreamTransport_tx(st)) < len) {
+        return pdFALSE;
+    }
+    (void)xStreamBufferSend(StreamTransport_tx(st), frame, len, 0U);
+    (*st->txKick)(); /* make sure the UART transmits */
+    return pdTRUE;
+}
+/*..........................................................................*/
+static void StreamTransport_rxThread(void *pvParameters) {
+    StreamTransport * const me = (StreamTransport *)pvParameters;
+    uint8_t buf[16];
+
+    for (;;) {
+        size_t const n = xStreamBufferReceive(StreamTransport_rx(me),
+                                              buf, sizeof(buf),
+                                              portMAX_DELAY); /* BLOCKING! */
+        RemoteLink_onRx(me->super.link, buf, (uint32_t)n);
+    }
+}
+/*..........................................................................*/
+uint32_t StreamTransport_txFromISR(StreamTransport * const me,
+                                   uint8_t *buf, uint32_t max,
+                                   BaseType_t *pxHigherPriorityTaskWoken)
+{
+    return (uint32_t)xStreamBufferReceiveFromISR(StreamTransport_tx(me),
+                                                 buf, max,
+                                                 pxHigherPriorityTaskWoken);
+}
+/*..........................................................................*/
+void StreamTransport_rxFromISR(StreamTransport * const me,
+                               uint8_t const *buf, uint32_t len,
+                               BaseType_t *pxHigherPriorityTaskWoken)
+{
+    /* bytes that do not fit are lost and the frame fails its CRC */
+    (void)xStreamBufferSendFromISR(StreamTransport_rx(me), buf, len,
+                                   pxHigherPriorityTaskWoken);
+}
+
+/*--------------------------------------------------------------------------*/
+/* In-memory loopback transport services... */
+
+static BaseType_t LoopbackTransport_send(Transport * const me,
+                                         uint8_t const *frame, uint16_t len);
+
+/*..........................................................................*/
+void LoopbackTransport_ctor(LoopbackTransport * const me,
+                            LoopbackTransport *peer)
+{
+    me->super.send = &LoopbackTransport_send;
+    me->super.link = (RemoteLink *)0; /* set by RemoteLink_ctor() */
+    me->peer = peer;
+}
+/*..........................................................................*/
+static BaseType_t LoopbackTransport_send(Transport * const me,
+                                         uint8_t const *frame, uint16_t len)
+{
+    LoopbackTransport * const lb = (LoopbackTransport *)me;
+    RemoteLink_onRx(lb->peer->super.link, frame, len);
+    return pdTRUE;
+}
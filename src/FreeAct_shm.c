@@ -0,0 +1,294 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Shared-memory event transport between processes (Linux)
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#if defined(__linux__)
+
+#define _GNU_SOURCE /* for syscall() */
+#include "FreeAct_shm.h" /* Free Active Object shared-memory link */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define SHM_MAGIC     0x46524541U /* "FREA" */
+#define SHM_LINE      64U         /* cache line [bytes] */
+#define SHM_ALIGN(x_) (((x_) + (SHM_LINE - 1U)) & ~(SHM_LINE - 1U))
+
+/* header of the shared region */
+typedef struct {
+    uint32_t volatile magic;    /* written last by side 0 */
+    uint32_t blockSize;
+    uint32_t nBlocks;
+    uint32_t ringLen;
+} ShmHeader;
+
+static uint32_t ShmLink_ringSize(uint32_t ringLen);
+static BaseType_t ShmRing_push(ShmRing * const r, uint32_t len, uint32_t v);
+static BaseType_t ShmRing_pop(ShmRing * const r, uint32_t len, uint32_t *v);
+static void ShmLink_giveBack(ShmLink * const me, uint32_t blk);
+static void *ShmLink_rxLoop(void *arg);
+
+/*..........................................................................*/
+static uint32_t ShmLink_ringSize(uint32_t ringLen) {
+    return SHM_ALIGN((uint32_t)offsetof(ShmRing, entry)
+                     + (ringLen * sizeof(uint32_t)));
+}
+/*..........................................................................*/
+static BaseType_t ShmRing_push(ShmRing * const r, uint32_t len, uint32_t v) {
+    uint32_t const head = r->head;
+    if ((head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE)) == len) {
+        return pdFALSE; /* full */
+    }
+    r->entry[head & (len - 1U)] = v;
+    __atomic_store_n(&r->head, head + 1U, __ATOMIC_RELEASE);
+    return pdTRUE;
+}
+/*..........................................................................*/
+static BaseType_t ShmRing_pop(ShmRing * const r, uint32_t len, uint32_t *v) {
+    uint32_t const tail = r->tail;
+    if (__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail) {
+        return pdFALSE; /* empty */
+    }
+    *v = r->entry[tail & (len - 1U)];
+    __atomic_store_n(&r->tail, tail + 1U, __ATOMIC_RELEASE);
+    return pdTRUE;
+}
+
+/*..........................................................................*/
+BaseType_t ShmLink_open(ShmLink * const me, char const *name, uint8_t side,
+                        uint32_t blockSize, uint32_t nBlocks,
+                        uint32_t ringLen,
+                        uint32_t *freeSto,
+                        IsrPost *chanSto, uint16_t chanLen)
+{
+    uint32_t const ringSize = ShmLink_ringSize(ringLen);
+    uint32_t poolSize;
+    uint32_t dir[2];
+    ShmHeader *hdr;
+    uint8_t i;
+    int fd;
+
+    /* the rings must hold all blocks, so that pushes never fail */
+    FREEACT_ASSERT((side <= 1U) && (nBlocks > 0U) && (nBlocks < 0x01000000U)
+                   && (ringLen >= nBlocks)
+                   && ((ringLen & (ringLen - 1U)) == 0U));
+
+    blockSize = (blockSize + 7U) & ~7U; /* 8-byte aligned blocks */
+    poolSize  = SHM_ALIGN(blockSize * nBlocks);
+    me->size  = SHM_LINE + 2U * ((2U * ringSize) + poolSize);
+    me->blockSize = blockSize;
+    me->nBlocks   = nBlocks;
+    me->ringLen   = ringLen;
+    me->side      = side;
+
+    fd = shm_open(name, (side == 0U) ? (O_CREAT | O_RDWR) : O_RDWR, 0600);
+    if (fd < 0) {
+        return pdFALSE;
+    }
+    if ((side == 0U) && (ftruncate(fd, (off_t)me->size) != 0)) {
+        (void)close(fd);
+        return pdFALSE;
+    }
+    me->base = (uint8_t *)mmap((void *)0, me->size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd, 0);
+    (void)close(fd); /* the mapping stays */
+    if (me->base == (uint8_t *)MAP_FAILED) {
+        return pdFALSE;
+    }
+
+    hdr = (ShmHeader *)me->base;
+    if (side == 0U) {
+        memset(me->base, 0, me->size);
+        hdr->blockSize = blockSize;
+        hdr->nBlocks   = nBlocks;
+        hdr->ringLen   = ringLen;
+        __atomic_store_n(&hdr->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+    }
+    else if ((__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC)
+             || (hdr->blockSize != blockSize) || (hdr->nBlocks != nBlocks)
+             || (hdr->ringLen != ringLen))
+    {
+        (void)munmap(me->base, me->size); /* not ready or not matching */
+        return pdFALSE;
+    }
+
+    /* per direction: message ring | return ring | event pool */
+    dir[0] = SHM_LINE;
+    dir[1] = SHM_LINE + (2U * ringSize) + poolSize;
+    me->tx     = (ShmRing *)&me->base[dir[side]];
+    me->txRet  = (ShmRing *)&me->base[dir[side] + ringSize];
+    me->txPool = &me->base[dir[side] + (2U * ringSize)];
+    me->rx     = (ShmRing *)&me->base[dir[side ^ 1U]];
+    me->rxRet  = (ShmRing *)&me->base[dir[side ^ 1U] + ringSize];
+    me->rxPool = &me->base[dir[side ^ 1U] + (2U * ringSize)];
+
+    me->freeBlk = freeSto;
+    for (me->nFree = 0U; me->nFree < nBlocks; ++me->nFree) {
+        freeSto[me->nFree] = me->nFree;
+    }
+    for (i = 0U; i < FREEACT_SHM_MAX_EXPORT; ++i) {
+        me->exports[i] = (Active *)0;
+    }
+    me->lost = 0U;
+    me->retLock = 0U;
+    IsrChannel_ctor(&me->chan, chanSto, chanLen);
+    return pdTRUE;
+}
+/*..........................................................................*/
+void ShmLink_export(ShmLink * const me, uint8_t id, Active *ao) {
+    FREEACT_ASSERT(id < FREEACT_SHM_MAX_EXPORT);
+    me->exports[id] = ao;
+}
+/*..........................................................................*/
+BaseType_t ShmLink_startRx(ShmLink * const me) {
+    return (pthread_create(&me->rxThread, (pthread_attr_t *)0,
+                           &ShmLink_rxLoop, me) == 0) ? pdTRUE : pdFALSE;
+}
+/*..........................................................................*/
+Event *ShmLink_alloc(ShmLink * const me, uint32_t size, Signal sig) {
+    Event *e = (Event *)0;
+    uint32_t blk;
+
+    FREEACT_ASSERT((size >= sizeof(Event)) && (size <= me->blockSize));
+
+    vTaskSuspendAll(); /* the tasks share the free blocks */
+    if (me->nFree == 0U) { /* reclaim the blocks given back */
+        while (ShmRing_pop(me->txRet, me->ringLen, &blk) == pdTRUE) {
+            me->freeBlk[me->nFree] = blk;
+            ++me->nFree;
+        }
+    }
+    if (me->nFree != 0U) {
+        --me->nFree;
+        e = (Event *)&me->txPool[me->freeBlk[me->nFree] * me->blockSize];
+    }
+    (void)xTaskResumeAll();
+
+    if (e != (Event *)0) {
+        e->sig = sig;
+    }
+    return e; /* NULL when the pool is exhausted */
+}
+/*..........................................................................*/
+void ShmLink_post(ShmLink * const me, uint8_t dst, Event const * const e) {
+    uint32_t const blk =
+        (uint32_t)(((uint8_t const *)e - me->txPool) / me->blockSize);
+    BaseType_t ok;
+
+    FREEACT_ASSERT(blk < me->nBlocks);
+
+    vTaskSuspendAll(); /* single producer of the ring */
+    ok = ShmRing_push(me->tx, me->ringLen, (blk << 8) | dst);
+    (void)xTaskResumeAll();
+    FREEACT_ASSERT(ok == pdTRUE); /* cannot fail, ringLen >= nBlocks */
+    (void)ok;
+
+    /* the only system call: wake up the receiver if it sleeps. Clearing
+    * the futex word makes a FUTEX_WAIT racing with this post fail its
+    * value check, so the wake-up cannot be lost.
+    */
+    if (__atomic_exchange_n(&me->tx->idle, 0U, __ATOMIC_SEQ_CST) != 0U) {
+        (void)syscall(SYS_futex, &me->tx->idle, FUTEX_WAKE, 1,
+                      (void *)0, (void *)0, 0);
+    }
+}
+/*..........................................................................*/
+static void ShmLink_giveBack(ShmLink * const me, uint32_t blk) {
+    BaseType_t ok;
+
+    while (__atomic_exchange_n(&me->retLock, 1U, __ATOMIC_ACQUIRE) != 0U) {
+        /* spin, the lock is held for a few instructions only */
+    }
+    ok = ShmRing_push(me->rxRet, me->ringLen, blk);
+    __atomic_store_n(&me->retLock, 0U, __ATOMIC_RELEASE);
+    FREEACT_ASSERT(ok == pdTRUE); /* cannot fail, ringLen >= nBlocks */
+    (void)ok;
+}
+/*..........................................................................*/
+void ShmLink_release(ShmLink * const me, Event const * const e) {
+    uint32_t const blk =
+        (uint32_t)(((uint8_t const *)e - me->rxPool) / me->blockSize);
+
+    FREEACT_ASSERT(blk < me->nBlocks);
+
+    vTaskSuspendAll(); /* don't get preempted while holding the lock */
+    ShmLink_giveBack(me, blk);
+    (void)xTaskResumeAll();
+}
+/*..........................................................................*/
+/* receiver thread (native, must not call the FreeRTOS API) */
+static void *ShmLink_rxLoop(void *arg) {
+    ShmLink * const me = (ShmLink *)arg;
+    uint32_t v;
+
+    for (;;) {
+        while (ShmRing_pop(me->rx, me->ringLen, &v) == pdTRUE) {
+            uint32_t const dst = (v & 0xFFU);
+            uint32_t const blk = (v >> 8);
+            Event const * const e =
+                (Event const *)&me->rxPool[blk * me->blockSize];
+
+            if ((dst >= FREEACT_SHM_MAX_EXPORT)
+                || (me->exports[dst] == (Active *)0))
+            {
+                ++me->lost;
+                ShmLink_giveBack(me, blk); /* nobody to take it */
+                continue;
+            }
+            while (IsrChannel_post(&me->chan, me->exports[dst], e)
+                   != pdTRUE)
+            {
+                (void)sched_yield(); /* back-pressure from the AOs */
+            }
+        }
+
+        /* ring empty: announce idle, re-check and sleep on the futex */
+        __atomic_store_n(&me->rx->idle, 1U, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&me->rx->head, __ATOMIC_SEQ_CST)
+            == me->rx->tail)
+        {
+            (void)syscall(SYS_futex, &me->rx->idle, FUTEX_WAIT, 1U,
+                          (void *)0, (void *)0, 0);
+        }
+        __atomic_store_n(&me->rx->idle, 0U, __ATOMIC_RELAXED);
+    }
+    return (void *)0;
+}
+
+#endif /* __linux__ */
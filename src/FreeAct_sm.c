@@ -0,0 +1,210 @@
+/*****************************************************************************
+* Free Active Object pattern implementation (FreeAct) based on FreeRTOS
+* Lightweight state machines hosted inside Active Objects
+*
+*                    Q u a n t u m  L e a P s
+*                    ------------------------
+*                    Modern Embedded Software
+*
+* Copyright (C) 2020 Quantum Leaps, LLC. All rights reserved.
+*
+* MIT License:
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to
+* deal in the Software without restriction, including without limitation the
+* rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+* sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* Contact information:
+* <www.state-machine.com>
+* <info@state-machine.com>
+*****************************************************************************/
+#include "FreeAct_sm.h" /* Free Active Object state machine interface */
+
+/*--------------------------------------------------------------------------*/
+/* State machine array services... */
+
+/*..........................................................................*/
+void SmArray_ctor(SmArray * const me,
+                  uint8_t *stateSto,       /* storage for nInst states */
+                  uint16_t nInst,
+                  SmHandler const *handlers,
+                  uint8_t nStates,
+                  uint8_t initial,         /* initial state of all instances */
+                  void *ctx)
+{
+    uint16_t i;
+
+    FREEACT_ASSERT((nInst > 0U) && (initial < nStates));
+
+    me->state    = stateSto;
+    me->handlers = handlers;
+    me->ctx      = ctx;
+    me->nInst    = nInst;
+    me->nStates  = nStates;
+    for (i = 0U; i < nInst; ++i) {
+        stateSto[i] = initial;
+    }
+}
+
+/*..........................................................................*/
+void SmArray_dispatch(SmArray * const me, uint16_t inst,
+                      Event const * const e)
+{
+    FREEACT_ASSERT(inst < me->nInst);
+    me->state[inst] = (*me->handlers[me->state[inst]])(me->ctx, inst, e);
+    FREEACT_ASSERT_DBG(me->state[inst] < me->nStates);
+}
+
+/*..........................................................................*/
+void SmArray_dispatchBatch(SmArray * const me,
+                           uint16_t const *inst, uint16_t n,
+                           Event const * const e)
+{
+    uint8_t * const state = me->state;
+    SmHandler const * const handlers = me->handlers;
+    void * const ctx = me->ctx;
+
+    for (; n > 0U; --n, ++inst) {
+        uint16_t const i = *inst;
+        FREEACT_ASSERT(i < me->nInst);
+        state[i] = (*handlers[state[i]])(ctx, i, e);
+        FREEACT_ASSERT_DBG(state[i] < me->nStates);
+    }
+}
+
+/*..........................................................................*/
+void SmArray_dispatchEvents(SmArray * const me,
+                            SmEvent const *evts, uint16_t n)
+{
+    uint8_t * const state = me->state;
+    SmHandler const * const handlers = me->handlers;
+    void * const ctx = me->ctx;
+
+    for (; n > 0U; --n, ++evts) {
+        uint16_t const i = evts->inst;
+        FREEACT_ASSERT(i < me->nInst);
+        state[i] = (*handlers[state[i]])(ctx, i, &evts->super);
+        FREEACT_ASSERT_DBG(state[i] < me->nStates);
+    }
+}
+
+/*..........................................................................*/
+void SmArray_broadcast(SmArray * const me, Event const * const e) {
+    uint8_t * const state = me->state;
+    SmHandler const * const handlers = me->handlers;
+    void * const ctx = me->ctx;
+    uint16_t const nInst = me->nInst;
+    uint16_t i;
+
+    for (i = 0U; i < nInst; ++i) { /* one pass over the contiguous states */
+        state[i] = (*handlers[state[i]])(ctx, i, e);
+        FREEACT_ASSERT_DBG(state[i] < me->nStates);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+/* Orthogonal component services... */
+
+static void ActiveContainer_route(ActiveContainer * const me,
+                                  Event const * const e);
+static void ActiveContainer_dispatch(Active * const me,
+                                     Event const * const e);
+
+/*..........................................................................*/
+void Component_ctor(Component * const me, ComponentHandler dispatch) {
+    me->dispatch  = dispatch;
+    me->container = (ActiveContainer *)0; /* set by ActiveContainer_ctor() */
+}
+/*..........................................................................*/
+/* post an event to the own container, to be routed in the current RTC step
+* right after the event being processed (no kernel queue involved)
+*/
+void Component_postContainer(Component * const me, Event const * const e) {
+    ActiveContainer * const cont = me->container;
+
+    FREEACT_ASSERT(cont->intUsed < FREEACT_MAX_INTERNAL);
+    cont->internal[cont->intHead] = e;
+    cont->intHead = (uint8_t)((cont->intHead + 1U) % FREEACT_MAX_INTERNAL);
+    ++cont->intUsed;
+}
+
+/*..........................................................................*/
+void ActiveContainer_ctor(ActiveContainer * const me,
+                          Component * const *comps, uint8_t nComps,
+                          uint8_t const *route, Signal nRoute)
+{
+    uint8_t i;
+
+    FREEACT_ASSERT((nComps > 0U) && (nComps < ROUTE_TARGET));
+
+    Active_ctor(&me->super, &ActiveContainer_dispatch);
+    me->comps   = comps;
+    me->nComps  = nComps;
+    me->route   = route;
+    me->nRoute  = nRoute;
+    me->intHead = 0U;
+    me->intTail = 0U;
+    me->intUsed = 0U;
+    for (i = 0U; i < nComps; ++i) {
+        comps[i]->container = me;
+    }
+}
+/*..........................................................................*/
+void ActiveContainer_dispatchTo(ActiveContainer * const me, uint8_t target,
+                                Event const * const e)
+{
+    Component * comp;
+
+    FREEACT_ASSERT(target < me->nComps);
+    comp = me->comps[target];
+    (*comp->dispatch)(comp, e);
+}
+/*..........................................................................*/
+static void ActiveContainer_route(ActiveContainer * const me,
+                                  Event const * const e)
+{
+    uint8_t r = (e->sig < me->nRoute) ? me->route[e->sig] : ROUTE_ALL;
+
+    if (r == ROUTE_TARGET) {
+        r = ((ComponentEvent const *)e)->target;
+    }
+    if (r == ROUTE_ALL) {
+        uint8_t i;
+        for (i = 0U; i < me->nComps; ++i) {
+            ActiveContainer_dispatchTo(me, i, e);
+        }
+    }
+    else {
+        ActiveContainer_dispatchTo(me, r, e);
+    }
+}
+/*..........................................................................*/
+static void ActiveContainer_dispatch(Active * const me,
+                                     Event const * const e)
+{
+    ActiveContainer * const cont = (ActiveContainer *)me;
+
+    ActiveContainer_route(cont, e);
+
+    /* the events posted by the components complete the same RTC step */
+    while (cont->intUsed != 0U) {
+        Event const * const ie = cont->internal[cont->intTail];
+        cont->intTail = (uint8_t)((cont->intTail + 1U) % FREEACT_MAX_INTERNAL);
+        --cont->intUsed;
+        ActiveContainer_route(cont, ie);
+    }
+}